@@ -1,514 +1,4977 @@
-/* main.c
- *
- * Simulador de Escalonamento (C - single file)
- * Implementa: FIFO, SJF (non-preemptive), RR (quantum 0.5s), MLFQ (3 níveis, quantum 0.5s)
- *
- * Uso:
- *   ./simulador <algorithm> <scenario> [repeat]
- * onde:
- *   algorithm = fifo | sjf | rr | mlfq
- *   scenario  = 1 | 2 | 3 | 4
- *   repeat    = (opcional) número de execuções para calcular médias (default 3)
- *
- * Saída: tabela com métricas por processo (Elapsed, CPU, BLOCKED, FirstRun) - médias
- *
- * Nota: simulação lógica (tempo calculado, sem dormir). Todas as chegadas em t=0.
- *
- * Compilar:
- *   gcc main.c -o simulador -lm
- *
- * Exemplo:
- *   ./simulador rr 2 3
- *
- */
-
-#include <stdio.h>
-#include <stdlib.h>
-#include <string.h>
-#include <math.h>
-
-#define QUANTUM 0.5   /* 500 ms */
-#define EPS 1e-9
-
-/* ----------------------- Tipos ----------------------- */
-
-typedef struct {
-    double when_cpu; /* CPU consumed at which IO starts */
-    double duration; /* IO duration (blocked time) */
-} IOEvent;
-
-typedef struct {
-    char name[16];
-    double total_cpu_needed;
-
-    /* IO events array */
-    IOEvent *io_events;
-    int io_count;
-
-    /* runtime state */
-    double remaining;
-    double cpu_consumed;
-    double blocked_time;
-    double first_run_time; /* -1 if not yet run */
-    double finish_time;    /* -1 if not finished */
-    int next_io_index;
-} Process;
-
-typedef struct {
-    char name[16];
-    double Elapsed;
-    double CPU;
-    double BLOCKED;
-    double FirstRun;
-} Result;
-
-/* ------------------- Funções utilitárias ------------------- */
-
-static Process * clone_processes(Process *src, int n) {
-    Process *dst = (Process*) malloc(sizeof(Process) * n);
-    for (int i = 0; i < n; ++i) {
-        dst[i] = src[i]; /* shallow copy */
-        /* deep copy IO events */
-        if (src[i].io_count > 0) {
-            dst[i].io_events = (IOEvent*) malloc(sizeof(IOEvent) * src[i].io_count);
-            for (int j = 0; j < src[i].io_count; ++j) dst[i].io_events[j] = src[i].io_events[j];
-        } else {
-            dst[i].io_events = NULL;
-        }
-        /* init runtime state */
-        dst[i].remaining = src[i].total_cpu_needed;
-        dst[i].cpu_consumed = 0.0;
-        dst[i].blocked_time = 0.0;
-        dst[i].first_run_time = -1.0;
-        dst[i].finish_time = -1.0;
-        dst[i].next_io_index = 0;
-    }
-    return dst;
-}
-
-static void free_processes(Process *p, int n) {
-    for (int i = 0; i < n; ++i) {
-        if (p[i].io_events) free(p[i].io_events);
-    }
-    free(p);
-}
-
-/* Consume até dt de CPU do processo.
- * Retorna taken (cpu efetivamente consumido) e io_dur (>=0 se IO ocorreu, -1 se nao) */
-static void eat_cpu(Process *p, double dt, double *taken, double *io_dur) {
-    *io_dur = -1.0;
-    if (p->next_io_index < p->io_count) {
-        IOEvent ev = p->io_events[p->next_io_index];
-        double cpu_until_io = ev.when_cpu - p->cpu_consumed;
-        if (cpu_until_io <= EPS) {
-            /* IO deveria ocorrer imediatamente */
-            p->next_io_index++;
-            p->blocked_time += ev.duration;
-            *taken = 0.0;
-            *io_dur = ev.duration;
-            return;
-        }
-        double take = dt;
-        if (take > cpu_until_io) take = cpu_until_io;
-        if (take > p->remaining) take = p->remaining;
-        p->cpu_consumed += take;
-        p->remaining -= take;
-        *taken = take;
-        if (fabs(p->cpu_consumed - ev.when_cpu) < 1e-6 || p->cpu_consumed > ev.when_cpu - 1e-9) {
-            p->next_io_index++;
-            p->blocked_time += ev.duration;
-            *io_dur = ev.duration;
-        }
-        return;
-    } else {
-        double take = dt;
-        if (take > p->remaining) take = p->remaining;
-        p->cpu_consumed += take;
-        p->remaining -= take;
-        *taken = take;
-        return;
-    }
-}
-
-/* verifica se processo terminado */
-static int is_done(Process *p) {
-    return p->remaining <= EPS;
-}
-
-/* copia resultados */
-static void fill_result(Result *r, Process *p) {
-    r->Elapsed = (p->finish_time < 0) ? 0.0 : p->finish_time;
-    r->CPU = p->cpu_consumed;
-    r->BLOCKED = p->blocked_time;
-    r->FirstRun = (p->first_run_time < 0) ? 0.0 : p->first_run_time;
-}
-
-/* ------------------- Cenários ------------------- */
-
-/* scenario 1: A 10, B 15, C 20 */
-static Process * make_scenario1(int *out_n) {
-    int n = 3;
-    Process *ps = (Process*) malloc(sizeof(Process) * n);
-    strcpy(ps[0].name, "A"); ps[0].total_cpu_needed = 10.0; ps[0].io_events = NULL; ps[0].io_count = 0;
-    strcpy(ps[1].name, "B"); ps[1].total_cpu_needed = 15.0; ps[1].io_events = NULL; ps[1].io_count = 0;
-    strcpy(ps[2].name, "C"); ps[2].total_cpu_needed = 20.0; ps[2].io_events = NULL; ps[2].io_count = 0;
-    *out_n = n;
-    return ps;
-}
-
-/* scenario 2: A5 B10 C4 D2 E3 F15 */
-static Process * make_scenario2(int *out_n) {
-    int n = 6;
-    Process *ps = (Process*) malloc(sizeof(Process) * n);
-    strcpy(ps[0].name, "A"); ps[0].total_cpu_needed = 5.0; ps[0].io_events = NULL; ps[0].io_count = 0;
-    strcpy(ps[1].name, "B"); ps[1].total_cpu_needed = 10.0; ps[1].io_events = NULL; ps[1].io_count = 0;
-    strcpy(ps[2].name, "C"); ps[2].total_cpu_needed = 4.0; ps[2].io_events = NULL; ps[2].io_count = 0;
-    strcpy(ps[3].name, "D"); ps[3].total_cpu_needed = 2.0; ps[3].io_events = NULL; ps[3].io_count = 0;
-    strcpy(ps[4].name, "E"); ps[4].total_cpu_needed = 3.0; ps[4].io_events = NULL; ps[4].io_count = 0;
-    strcpy(ps[5].name, "F"); ps[5].total_cpu_needed = 15.0; ps[5].io_events = NULL; ps[5].io_count = 0;
-    *out_n = n;
-    return ps;
-}
-
-/* scenario 3: A-5.csv, B-5.csv, C-5.csv equivalent embedded */
-/* We'll create example IO sequences meaningful for testing */
-static Process * make_scenario3(int *out_n) {
-    int n = 3;
-    Process *ps = (Process*) malloc(sizeof(Process) * n);
-
-    /* A: total 5, IO events: at 1.0 (0.5), at 3.0 (0.7) */
-    strcpy(ps[0].name, "A"); ps[0].total_cpu_needed = 5.0;
-    ps[0].io_count = 2;
-    ps[0].io_events = (IOEvent*) malloc(sizeof(IOEvent) * 2);
-    ps[0].io_events[0].when_cpu = 1.0; ps[0].io_events[0].duration = 0.5;
-    ps[0].io_events[1].when_cpu = 3.0; ps[0].io_events[1].duration = 0.7;
-
-    /* B: total 5, IO events: at 2.0 (0.4) */
-    strcpy(ps[1].name, "B"); ps[1].total_cpu_needed = 5.0;
-    ps[1].io_count = 1;
-    ps[1].io_events = (IOEvent*) malloc(sizeof(IOEvent) * 1);
-    ps[1].io_events[0].when_cpu = 2.0; ps[1].io_events[0].duration = 0.4;
-
-    /* C: total 5, IO events: at 0.5 (0.2), at 2.5 (1.0) */
-    strcpy(ps[2].name, "C"); ps[2].total_cpu_needed = 5.0;
-    ps[2].io_count = 2;
-    ps[2].io_events = (IOEvent*) malloc(sizeof(IOEvent) * 2);
-    ps[2].io_events[0].when_cpu = 0.5; ps[2].io_events[0].duration = 0.2;
-    ps[2].io_events[1].when_cpu = 2.5; ps[2].io_events[1].duration = 1.0;
-
-    *out_n = n;
-    return ps;
-}
-
-/* scenario 4: A-6.csv, B-6.csv, C-6.csv equivalent embedded */
-static Process * make_scenario4(int *out_n) {
-    int n = 3;
-    Process *ps = (Process*) malloc(sizeof(Process) * n);
-
-    /* A: total 6, IO events */
-    strcpy(ps[0].name, "A"); ps[0].total_cpu_needed = 6.0;
-    ps[0].io_count = 2;
-    ps[0].io_events = (IOEvent*) malloc(sizeof(IOEvent) * 2);
-    ps[0].io_events[0].when_cpu = 1.2; ps[0].io_events[0].duration = 0.6;
-    ps[0].io_events[1].when_cpu = 4.0; ps[0].io_events[1].duration = 0.8;
-
-    /* B: total 6, IO events */
-    strcpy(ps[1].name, "B"); ps[1].total_cpu_needed = 6.0;
-    ps[1].io_count = 1;
-    ps[1].io_events = (IOEvent*) malloc(sizeof(IOEvent) * 1);
-    ps[1].io_events[0].when_cpu = 3.5; ps[1].io_events[0].duration = 0.5;
-
-    /* C: total 6, IO events */
-    strcpy(ps[2].name, "C"); ps[2].total_cpu_needed = 6.0;
-    ps[2].io_count = 3;
-    ps[2].io_events = (IOEvent*) malloc(sizeof(IOEvent) * 3);
-    ps[2].io_events[0].when_cpu = 0.8; ps[2].io_events[0].duration = 0.3;
-    ps[2].io_events[1].when_cpu = 2.0; ps[2].io_events[1].duration = 0.4;
-    ps[2].io_events[2].when_cpu = 4.5; ps[2].io_events[2].duration = 0.6;
-
-    *out_n = n;
-    return ps;
-}
-
-/* Generic factory */
-static Process * make_scenario(int scen, int *out_n) {
-    if (scen == 1) return make_scenario1(out_n);
-    if (scen == 2) return make_scenario2(out_n);
-    if (scen == 3) return make_scenario3(out_n);
-    if (scen == 4) return make_scenario4(out_n);
-    *out_n = 0;
-    return NULL;
-}
-
-/* ------------------- Algoritmos de escalonamento ------------------- */
-
-/* FIFO: cada processo corre até IO ou terminar (não preemptivo aqui) */
-static Result* run_fifo(Process *orig, int n, int *out_count) {
-    Process *procs = clone_processes(orig, n);
-    Result *res = (Result*) malloc(sizeof(Result) * n);
-    double t = 0.0;
-    int idx = 0;
-    for (int i = 0; i < n; ++i) {
-        Process *p = &procs[i];
-        if (p->first_run_time < 0) p->first_run_time = t;
-        while (!is_done(p)) {
-            double taken, io_dur;
-            eat_cpu(p, p->remaining, &taken, &io_dur); /* try to finish or reach next IO */
-            t += taken;
-            if (io_dur >= 0.0) { t += io_dur; }
-        }
-        p->finish_time = t;
-        fill_result(&res[idx++], p);
-        strcpy(res[idx-1].name, p->name);
-    }
-    *out_count = idx;
-    free_processes(procs, n);
-    return res;
-}
-
-/* SJF non-preemptivo: ordenar por total_cpu_needed e executar cada um até terminar/IO */
-static int cmp_total_cpu(const void *a, const void *b) {
-    const Process *pa = (const Process*) a;
-    const Process *pb = (const Process*) b;
-    if (pa->total_cpu_needed < pb->total_cpu_needed) return -1;
-    if (pa->total_cpu_needed > pb->total_cpu_needed) return 1;
-    return 0;
-}
-
-static Result* run_sjf(Process *orig, int n, int *out_count) {
-    /* clonamos e ordenamos por total_cpu_needed */
-    Process *procs = clone_processes(orig, n);
-    qsort(procs, n, sizeof(Process), cmp_total_cpu);
-    Result *res = (Result*) malloc(sizeof(Result) * n);
-    double t = 0.0;
-    int idx = 0;
-    for (int i = 0; i < n; ++i) {
-        Process *p = &procs[i];
-        if (p->first_run_time < 0) p->first_run_time = t;
-        while (!is_done(p)) {
-            double taken, io_dur;
-            eat_cpu(p, p->remaining, &taken, &io_dur);
-            t += taken;
-            if (io_dur >= 0.0) t += io_dur;
-        }
-        p->finish_time = t;
-        fill_result(&res[idx++], p);
-        strcpy(res[idx-1].name, p->name);
-    }
-    *out_count = idx;
-    free_processes(procs, n);
-    return res;
-}
-
-/* RR: round-robin com quantum QUANTUM */
-static Result* run_rr(Process *orig, int n, int *out_count) {
-    Process *procs = clone_processes(orig, n);
-    /* queue por pointers: simples array dinâmica */
-    Process **queue = (Process**) malloc(sizeof(Process*) * n * 2);
-    int qstart = 0, qend = 0;
-    for (int i = 0; i < n; ++i) queue[qend++] = &procs[i];
-
-    Result *res = (Result*) malloc(sizeof(Result) * n);
-    int res_idx = 0;
-    double t = 0.0;
-    while (qstart < qend) {
-        Process *p = queue[qstart++];
-        if (p->first_run_time < 0) p->first_run_time = t;
-        double taken, io_dur;
-        eat_cpu(p, QUANTUM, &taken, &io_dur);
-        t += taken;
-        if (io_dur >= 0.0) {
-            t += io_dur;
-        }
-        if (!is_done(p)) {
-            /* re-enqueue */
-            queue[qend++] = p;
-        } else {
-            p->finish_time = t;
-            fill_result(&res[res_idx++], p);
-            strcpy(res[res_idx-1].name, p->name);
-        }
-    }
-    free(queue);
-    *out_count = res_idx;
-    free_processes(procs, n);
-    return res;
-}
-
-/* MLFQ simples: 3 filas (0..2). Quantum = QUANTUM. Se usar todo o quantum, desce de fila. */
-static Result* run_mlfq(Process *orig, int n, int *out_count) {
-    const int LEVELS = 3;
-    Process *procs = clone_processes(orig, n);
-    /* filas de pointers; implementamos com arrays dinâmicos por fila */
-    Process ***queues = (Process***) malloc(sizeof(Process**) * LEVELS);
-    int *qsize = (int*) malloc(sizeof(int) * LEVELS);
-    int *qcap  = (int*) malloc(sizeof(int) * LEVELS);
-    for (int i = 0; i < LEVELS; ++i) {
-        qcap[i] = n + 4;
-        queues[i] = (Process**) malloc(sizeof(Process*) * qcap[i]);
-        qsize[i] = 0;
-    }
-    /* inserir todos na fila 0 */
-    for (int i = 0; i < n; ++i) queues[0][qsize[0]++] = &procs[i];
-
-    Result *res = (Result*) malloc(sizeof(Result) * n);
-    int res_idx = 0;
-    double t = 0.0;
-    /* enquanto alguma fila tiver elementos */
-    int any = 1;
-    while (1) {
-        any = 0;
-        for (int i = 0; i < LEVELS; ++i) if (qsize[i] > 0) { any = 1; break; }
-        if (!any) break;
-        /* encontra fila mais alta não vazia */
-        int qidx = -1;
-        for (int i = 0; i < LEVELS; ++i) if (qsize[i] > 0) { qidx = i; break; }
-        if (qidx == -1) break;
-        /* pop from queue qidx (FIFO within level) */
-        Process *p = queues[qidx][0];
-        /* shift left */
-        for (int j = 1; j < qsize[qidx]; ++j) queues[qidx][j-1] = queues[qidx][j];
-        qsize[qidx]--;
-        if (p->first_run_time < 0) p->first_run_time = t;
-        double taken, io_dur;
-        eat_cpu(p, QUANTUM, &taken, &io_dur);
-        t += taken;
-        if (io_dur >= 0.0) t += io_dur;
-        if (is_done(p)) {
-            p->finish_time = t;
-            fill_result(&res[res_idx++], p);
-            strcpy(res[res_idx-1].name, p->name);
-        } else {
-            /* se usou todo o quantum, descer (a não ser que esteja na última fila) */
-            int new_q = qidx;
-            if (fabs(taken - QUANTUM) < 1e-9 || taken > QUANTUM - 1e-9) {
-                if (qidx < LEVELS - 1) new_q = qidx + 1;
-            } else {
-                /* não usou todo o quantum (IO ocorreu cedo) -> mantém nível */
-                new_q = qidx;
-            }
-            /* enqueue em new_q */
-            if (qsize[new_q] >= qcap[new_q]) {
-                qcap[new_q] *= 2;
-                queues[new_q] = (Process**) realloc(queues[new_q], sizeof(Process*) * qcap[new_q]);
-            }
-            queues[new_q][qsize[new_q]++] = p;
-        }
-    }
-
-    for (int i = 0; i < LEVELS; ++i) free(queues[i]);
-    free(queues); free(qsize); free(qcap);
-    *out_count = res_idx;
-    free_processes(procs, n);
-    return res;
-}
-
-/* ------------------- Helper para médias e impressão ------------------- */
-
-static Result* accumulate_results(Result **runs, int run_count, int proc_count) {
-    /* runs is array of pointers length run_count, each points to array proc_count results.
-     * We assume order of processes is same across runs (by name order is not guaranteed),
-     * so we'll average by name matching.
-     */
-    Result *avg = (Result*) malloc(sizeof(Result) * proc_count);
-    for (int i = 0; i < proc_count; ++i) {
-        /* initialize with first run */
-        avg[i] = runs[0][i];
-    }
-    /* build name->index map from first run */
-    /* For simplicity, we'll treat processes in the order of runs[0]. */
-    for (int r = 1; r < run_count; ++r) {
-        for (int i = 0; i < proc_count; ++i) {
-            /* find in runs[r] the same name */
-            int found = -1;
-            for (int j = 0; j < proc_count; ++j) {
-                if (strcmp(runs[r][j].name, avg[i].name) == 0) { found = j; break; }
-            }
-            if (found >= 0) {
-                avg[i].Elapsed += runs[r][found].Elapsed;
-                avg[i].CPU += runs[r][found].CPU;
-                avg[i].BLOCKED += runs[r][found].BLOCKED;
-                avg[i].FirstRun += runs[r][found].FirstRun;
-            } else {
-                /* mismatch; but to be robust, skip */
-            }
-        }
-    }
-    for (int i = 0; i < proc_count; ++i) {
-        avg[i].Elapsed /= run_count;
-        avg[i].CPU /= run_count;
-        avg[i].BLOCKED /= run_count;
-        avg[i].FirstRun /= run_count;
-    }
-    return avg;
-}
-
-static void print_results(const char *algorithm, int scenario, Result *avg, int proc_count) {
-    printf("\n=== Resultado médio (algoritmo: %s, cenário: %d) ===\n", algorithm, scenario);
-    printf("%6s | %8s | %8s | %8s | %8s\n", "Proc", "Elapsed", "CPU", "BLOCKED", "FirstRun");
-    printf("--------------------------------------------------------------\n");
-    for (int i = 0; i < proc_count; ++i) {
-        printf("%6s | %8.3f | %8.3f | %8.3f | %8.3f\n",
-               avg[i].name, avg[i].Elapsed, avg[i].CPU, avg[i].BLOCKED, avg[i].FirstRun);
-    }
-    printf("--------------------------------------------------------------\n");
-}
-
-/* ------------------- Main / CLI ------------------- */
-
-int main(int argc, char **argv) {
-    if (argc < 3) {
-        printf("Uso: %s <algorithm> <scenario> [repeat]\n", argv[0]);
-        printf(" algorithm = fifo | sjf | rr | mlfq\n");
-        printf(" scenario = 1 | 2 | 3 | 4\n");
-        printf(" repeat = (opcional) número de execuções para média (default 3)\n");
-        return 1;
-    }
-    const char *alg = argv[1];
-    int scenario = atoi(argv[2]);
-    int repeat = 3;
-    if (argc >= 4) repeat = atoi(argv[3]);
-    if (repeat < 1) repeat = 1;
-
-    int base_n;
-    Process *base = make_scenario(scenario, &base_n);
-    if (!base) {
-        fprintf(stderr, "Cenário inválido: %d\n", scenario);
-        return 1;
-    }
-
-    /* runs will store pointers to result arrays for each run */
-    Result **runs = (Result**) malloc(sizeof(Result*) * repeat);
-    int proc_count = 0;
-
-    for (int r = 0; r < repeat; ++r) {
-        int out_count = 0;
-        Result *res = NULL;
-        if (strcmp(alg, "fifo") == 0) {
-            res = run_fifo(base, base_n, &out_count);
-        } else if (strcmp(alg, "sjf") == 0) {
-            res = run_sjf(base, base_n, &out_count);
-        } else if (strcmp(alg, "rr") == 0) {
-            res = run_rr(base, base_n, &out_count);
-        } else if (strcmp(alg, "mlfq") == 0) {
-            res = run_mlfq(base, base_n, &out_count);
-        } else {
-            fprintf(stderr, "Algoritmo inválido: %s\n", alg);
-            free(base);
-            return 1;
-        }
-        runs[r] = res;
-        proc_count = out_count;
-    }
-
-    Result *avg = accumulate_results(runs, repeat, proc_count);
-    print_results(alg, scenario, avg, proc_count);
-
-    /* cleanup */
-    for (int r = 0; r < repeat; ++r) free(runs[r]);
-    free(runs);
-    free(avg);
-    free_processes(base, base_n);
-
-    return 0;
-}
+/* Main.c
+ *
+ * Simulador de Escalonamento (C - single file)
+ * Implementa: FIFO, SJF (non-preemptive), RR (quantum 0.5s), MLFQ (3 níveis, quantum 0.5s)
+ *
+ * Uso:
+ *   ./simulador <algorithm> <scenario> [repeat] [-j workers] [-x custo]
+ * onde:
+ *   algorithm = fifo | sjf | rr | mlfq
+ *   scenario  = 1 | 2 | 3 | 4
+ *   repeat    = (opcional) número de execuções para calcular médias (default 3)
+ *   workers   = (opcional) corre as repetições em processos filho isolados,
+ *               com os resultados numa região MAP_SHARED (default 1 = sem fork)
+ *   custo     = (opcional) segundos somados ao relógio em cada troca de processo,
+ *               ou um ficheiro gerado por ctxsw/ctxsw.c -o (default 0)
+ *
+ *   ./simulador <algorithm> <scenario> ... --cpus K [-i beta] [--epoch t] [--place p] [--threads T]
+ * Multi-CPU: K CPUs, cada um com as suas filas. Em cada fronteira de época
+ * (default 1.0) CPUs sem trabalho roubam a quem tem processos à espera e as
+ * chegadas da época seguinte são colocadas com p = rr | least | random.
+ * Um processo com mem_intensity m corre mais devagar quando os outros CPUs
+ * estiveram ocupados com processos de memória na época anterior:
+ *   abrandamento = 1 + beta * m * soma(intensidade média dos outros CPUs)
+ * beta vem de "./simulador stream" (valor ou ficheiro em -i, default 0).
+ * Com --threads T os K CPUs são repartidos por T threads que correm cada
+ * época em paralelo e trocam migrações e chegadas por caixas de correio
+ * lock-free nas fronteiras; o resultado é igual ao de T = 1.
+ * O scenario pode ser um ficheiro, uma linha por processo:
+ *   nome cpu [arrival=t] [mem=m] [io=quando:duração,...]
+ *
+ *   ./simulador stream [-t threads] [-m MB] [-o ficheiro]
+ * Mede a largura de banda por thread da triad do STREAM com 1..threads
+ * threads em CPUs distintos e ajusta beta (escreve interference=beta com -o).
+ *
+ *   ./simulador real <algorithm> [-c cpu] "<comando>" "<comando>" ...
+ * Modo real: lança os comandos (como exec/exec.c), todos parados, e
+ * escalona-os em user space num único CPU com SIGSTOP/SIGCONT e um timerfd
+ * com o quantum. algorithm = fifo | rr | mlfq. Mede Elapsed/CPU/BLOCKED/
+ * FirstRun reais (wait4) e imprime a mesma tabela que a simulação.
+ *
+ * Saída: tabela com métricas por processo (Elapsed, CPU, BLOCKED, FirstRun) - médias,
+ * seguida das referências offline para o mesmo traço e a distância da política
+ * a cada uma: Elapsed médio ótimo (SRPT; com K CPUs, SRPT num CPU K vezes mais
+ * rápido), Elapsed médio em processor sharing ideal e o limite inferior do
+ * makespan. Calculadas com heaps em O(n log n), sem custo de troca.
+ *
+ * Nota: simulação lógica (tempo calculado, sem dormir). Nos cenários 1-4 todas
+ * as chegadas são em t=0; ficheiros de cenário (arrival=t) e cargas geradas
+ * ("gen") têm chegadas ao longo do tempo.
+ *
+ *   ./simulador calibrate <algorithm> <scenario> [-p other|rr] [-s escala] [-c cpu]
+ * Calibração: corre cada processo do cenário como um programa sintético real
+ * (queima CPU e dorme nos IOEvent) sob SCHED_OTHER ou SCHED_RR num CPU fixo,
+ * e mostra o erro por processo face à previsão do simulador. escala = segundos
+ * reais por segundo simulado (default 0.01). Como nos outros modos, o cenário
+ * pode ser 1-4 ou um ficheiro; cada filho dorme até à sua chegada.
+ *
+ *   ./simulador host <scenario> [-p políticas] [-c cpus] [-n nices] [-s escala]
+ * Corre os processos sintéticos do cenário sob as classes do kernel
+ * (other, batch, idle, fifo, rr, deadline; nice por processo com -n),
+ * confinados aos CPUs dados (ex.: 0,2-3), e lê o run delay de
+ * /proc/<pid>/schedstat. Classes sem privilégios são ignoradas com aviso.
+ *
+ *   ./simulador cluster <algorithm> <scenario|gen> [--hosts H] [--dispatch d] [--jobs N]
+ *                       [--load rho] [--mean S] [--fanout k] [--hedge d] [--seed s] [-x custo]
+ *                       [--autoscale util|queue[,...]] [--target a,...] [--min m] [--period p]
+ *                       [--delay d,...] [--cooldown c,...] [--slo s] [--threads T]
+ * Cluster: H hosts de um CPU, cada um com a política local, atrás de um
+ * dispatcher d = random | rr | jsq (fila mais curta) | po2 (melhor de dois
+ * ao acaso) | least (menos CPU pendente). "gen" gera N jobs com chegadas de
+ * Poisson à carga rho e serviço exponencial de média S (default 100000,
+ * 0.8, 1.0); um ficheiro de cenário usa as suas chegadas. Cada pedido abre
+ * k folhas (--fanout em "gen", fanout=k no ficheiro) em hosts escolhidos
+ * uma a uma e só termina com a mais lenta; --hedge d duplica noutro host
+ * as folhas que ao fim de d ainda não terminaram (ganha a primeira cópia).
+ * Imprime média e percentis de Elapsed/FirstRun por folha e, com fan-out
+ * ou hedging, por pedido; o CPU gasto nas cópias perdedoras; utilização
+ * e eventos/s. O ciclo de eventos recolhe o Elapsed de cada folha por
+ * ordem de conclusão: corta o aquecimento (MSER-5) e dá a média em regime
+ * estacionário com IC de 95 % por batch means (30 lotes), numa só corrida.
+ * Autoscaling: começa com m hosts (H é o máximo) e de p em p (default 10)
+ * o controlador vê a utilização e os jobs por host ativo e pede hosts:
+ * util segue um alvo de utilização (default 0.7), queue um alvo de jobs
+ * por host (default 2). Hosts novos demoram d a arrancar (default 30), a
+ * seguir a cada decisão há c sem decisões (default 60) e os hosts a mais
+ * escoam a fila antes de desligar. Reporta CPU-horas (unidade de tempo =
+ * segundo) e a fração de pedidos dentro do SLO s (default 10 S). Listas
+ * em --autoscale/--target/--delay/--cooldown varrem todas as combinações
+ * em paralelo (T threads) e imprimem uma linha por configuração.
+ *
+ *   ./simulador tune <scenario|gen> [--jobs N] [--load rho] [--mean S] [--seed s]
+ *                    [-w peso] [--eta k] [--threads T] [-x custo]
+ * Afina o MLFQ de um CPU: níveis (1..5), quantum por nível (não
+ * decrescente) e período de priority boost, para o objetivo
+ * peso * p99(Elapsed) + FirstRun médio (peso default 1). Successive halving
+ * em paralelo: todas as combinações da grelha em janelas pequenas do
+ * traço, fica 1/k em cada ronda (default 3) com janelas k vezes maiores,
+ * e os finalistas correm o traço completo; segue-se uma subida de encosta
+ * à volta do melhor. Imprime a fronteira de Pareto (p99 x FirstRun), a
+ * melhor configuração e a do run_mlfq. "gen" como no cluster, com um CPU
+ * (default 50000 jobs, carga 0.8).
+ *
+ *   ./simulador fast fifo|sjf [--jobs N] [--load rho] [--mean S] [--seed s] [--threads T]
+ *                             [--check] [-x custo]
+ * fifo e sjf num CPU não têm preempção, por isso os tempos de fim são uma
+ * soma de prefixos (max-plus com chegadas) de troca + CPU + IO pela ordem
+ * de despacho. O simulador usa sempre essa forma fechada para fifo (com ou
+ * sem chegadas) e sjf (sem chegadas) num CPU. "fast" avalia N jobs gerados
+ * (default 10^7, serviço exponencial de média S; --load rho > 0 acrescenta
+ * chegadas de Poisson, só fifo) em arrays simples com T threads, sjf com
+ * ordenação radix paralela; --check confirma os primeiros 10^5 contra a
+ * simulação passo a passo.
+ *
+ *   ./simulador analytic <scenario|gen> [--cpus K] [--jobs N] [--load rho] [--mean S] [--seed s]
+ *                        [--validate n] [--epoch t] [-x custo]
+ * Respostas imediatas sem simular: ajusta aos momentos medidos do traço
+ * (taxa e c_a² das chegadas, E[S] e c_s² do serviço CPU + IO) os modelos
+ * M/G/K FCFS (Erlang C escalado por (1 + c_s²)/2, Pollaczek-Khinchine com
+ * K = 1), M/G/K PS e MVA aberto (Seidmann para K CPUs), e imprime Elapsed,
+ * FirstRun e processos no sistema previstos e o tempo que os modelos
+ * levaram (µs). Sem chegadas usa MVA fechado com o lote a escoar. Com
+ * --validate n simula fifo e rr nos primeiros n processos com K CPUs e
+ * mostra o erro de cada modelo (fifo contra FCFS/MVA, rr contra PS). Com
+ * K > 1 a simulação tem filas por CPU e chegadas colocadas nas fronteiras
+ * de época, por isso o erro desce com --epoch menor. "gen" como no tune,
+ * à carga rho por CPU.
+ *
+ *   ./simulador adversary <algorithm> [--metric m] [--procs n] [--budget B] [--pop P]
+ *                         [--gens G] [--top k] [--threads T] [--seed s] [-o prefixo] [-x custo]
+ * Procura as cargas que mais fazem sofrer a política num CPU: algoritmo
+ * genético sobre n processos (default 8) com CPU total <= B (default 40),
+ * que muta bursts, colocação e duração de IO e rajadas de chegadas, para
+ * maximizar m = starvation (maior espera seguida na fila, default) | p99
+ * (de Elapsed) | slowdown (maior Elapsed/CPU). P candidatos (default 128)
+ * por geração durante G gerações (default 200), avaliados num pool de T
+ * threads. Escreve as k piores cargas (default 3) em <prefixo>1.txt, ...
+ * (default pior_), no formato dos ficheiros de cenário.
+ *
+ *   ./simulador green <algorithm> <scenario> [-w workers] [-s escala]
+ *   ./simulador green bench [-n trocas]
+ * Runtime M:N: cada processo do cenário é uma corrotina (ucontext) que queima
+ * CPU real e estaciona nos IOEvent sem bloquear o worker; N threads worker
+ * escalonam as corrotinas com as mesmas regras de fifo/sjf/rr/mlfq (preempção
+ * cooperativa no fim do quantum). "bench" compara o custo de uma troca de
+ * contexto entre corrotinas com a de pthreads.
+ *
+ * Compilar:
+ *   gcc Main.c -o simulador -lm -pthread
+ *
+ * Exemplo:
+ *   ./simulador rr 2 3
+ *   ./simulador stream -o stream.conf && ./simulador rr carga.txt --cpus 4 -i stream.conf
+ *   ./simulador real mlfq "sha256sum /usr/bin/gcc" "sleep 1"
+ *   ./simulador calibrate rr 3 -p rr -s 0.02
+ *   ./simulador host 4 -p other,rr -c 0 -n 0,5,10
+ *   ./simulador cluster rr gen --hosts 10000 --jobs 1000000 --dispatch jsq
+ *   ./simulador cluster rr gen --hosts 200 --min 100 --autoscale util,queue --target 0.6,0.8 --delay 0,30
+ *   ./simulador tune gen --load 0.9 -w 0.5
+ *   ./simulador fast fifo --jobs 100000000 --load 0.9 --check
+ *   ./simulador analytic gen --cpus 4 --load 0.9 --validate 50000
+ *   ./simulador adversary mlfq --metric starvation -o /tmp/pior_ && ./simulador mlfq /tmp/pior_1.txt
+ *   ./simulador green mlfq 4 -w 2
+ *
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <time.h>
+#include <ucontext.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <sys/timerfd.h>
+#include <sys/wait.h>
+
+#define QUANTUM 0.5   /* 500 ms */
+#define EPS 1e-9
+#define MAX_WORKERS 64
+#define MLFQ_LEVELS 3
+#define REAL_DEMOTE_FRACTION 0.9 /* CPU mínimo no quantum para descer de nível (modo real) */
+#define GREEN_STACK (64 * 1024)
+#define GREEN_MAX_WORKERS 64
+
+/* ----------------------- Tipos ----------------------- */
+
+typedef struct {
+    double when_cpu; /* CPU consumed at which IO starts */
+    double duration; /* IO duration (blocked time) */
+} IOEvent;
+
+typedef struct Process {
+    char name[16];
+    double total_cpu_needed;
+
+    /* IO events array */
+    IOEvent *io_events;
+    int io_count;
+
+    double arrival;       /* instante de chegada (0 nos cenários embutidos) */
+    double mem_intensity; /* 0..1: fração do CPU presa à memória (modelo de interferência) */
+    int fanout;           /* folhas por pedido (modo cluster), 1 nos restantes */
+
+    /* runtime state */
+    double remaining;
+    double cpu_consumed;
+    double blocked_time;
+    double first_run_time; /* -1 if not yet run */
+    double finish_time;    /* -1 if not finished */
+    int next_io_index;
+    double stall_time;     /* CPU perdido por interferência de co-runners */
+    int level;             /* fila MLFQ (modo multi-CPU) */
+    double ready_time;     /* fim do último slice (modo multi-CPU): só corre a partir daí */
+    int id;                /* índice na carga original */
+    struct Process *mail_next; /* caixa de correio entre partições */
+    int mail_kind;
+} Process;
+
+typedef struct {
+    char name[16];
+    double Elapsed;
+    double CPU;
+    double BLOCKED;
+    double FirstRun;
+} Result;
+
+/* ------------------- Funções utilitárias ------------------- */
+
+static double real_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* init runtime state */
+static void reset_process(Process *p, int id) {
+    p->remaining = p->total_cpu_needed;
+    p->cpu_consumed = 0.0;
+    p->blocked_time = 0.0;
+    p->first_run_time = -1.0;
+    p->finish_time = -1.0;
+    p->next_io_index = 0;
+    p->stall_time = 0.0;
+    p->level = 0;
+    p->ready_time = 0.0;
+    p->id = id;
+}
+
+static Process * clone_processes(Process *src, int n) {
+    Process *dst = (Process*) malloc(sizeof(Process) * n);
+    for (int i = 0; i < n; ++i) {
+        dst[i] = src[i]; /* shallow copy */
+        /* deep copy IO events */
+        if (src[i].io_count > 0) {
+            dst[i].io_events = (IOEvent*) malloc(sizeof(IOEvent) * src[i].io_count);
+            for (int j = 0; j < src[i].io_count; ++j) dst[i].io_events[j] = src[i].io_events[j];
+        } else {
+            dst[i].io_events = NULL;
+        }
+        reset_process(&dst[i], i);
+    }
+    return dst;
+}
+
+static void free_processes(Process *p, int n) {
+    for (int i = 0; i < n; ++i) {
+        if (p[i].io_events) free(p[i].io_events);
+    }
+    free(p);
+}
+
+/* Consume até dt de CPU do processo.
+ * Retorna taken (cpu efetivamente consumido) e io_dur (>=0 se IO ocorreu, -1 se nao) */
+static void eat_cpu(Process *p, double dt, double *taken, double *io_dur) {
+    *io_dur = -1.0;
+    if (p->next_io_index < p->io_count) {
+        IOEvent ev = p->io_events[p->next_io_index];
+        double cpu_until_io = ev.when_cpu - p->cpu_consumed;
+        if (cpu_until_io <= EPS) {
+            /* IO deveria ocorrer imediatamente */
+            p->next_io_index++;
+            p->blocked_time += ev.duration;
+            *taken = 0.0;
+            *io_dur = ev.duration;
+            return;
+        }
+        double take = dt;
+        if (take > cpu_until_io) take = cpu_until_io;
+        if (take > p->remaining) take = p->remaining;
+        p->cpu_consumed += take;
+        p->remaining -= take;
+        *taken = take;
+        if (fabs(p->cpu_consumed - ev.when_cpu) < 1e-6 || p->cpu_consumed > ev.when_cpu - 1e-9) {
+            p->next_io_index++;
+            p->blocked_time += ev.duration;
+            *io_dur = ev.duration;
+        }
+        return;
+    } else {
+        double take = dt;
+        if (take > p->remaining) take = p->remaining;
+        p->cpu_consumed += take;
+        p->remaining -= take;
+        *taken = take;
+        return;
+    }
+}
+
+/* "a,b,c" -> out; devolve quantos números leu (0 se algum é inválido) */
+static int parse_list(const char *arg, double *out, int max) {
+    int n = 0;
+    const char *p = arg;
+    while (*p && n < max) {
+        char *end;
+        out[n++] = strtod(p, &end);
+        if (end == p || out[n - 1] < 0.0) return 0;
+        p = *end == ',' ? end + 1 : end;
+        if (*end && *end != ',') return 0;
+    }
+    return n;
+}
+
+static int cmp_double(const void *a, const void *b) {
+    double x = *(const double*) a, y = *(const double*) b;
+    return (x > y) - (x < y);
+}
+
+/* Custo de mudar de processo no CPU (opção -x; 0 = trocas gratuitas) */
+static double switch_cost = 0.0;
+
+/* Atribui o CPU a p: cobra a troca se o anterior era outro processo */
+static void dispatch(Process *p, Process **last, double *t) {
+    if (*last && *last != p) *t += switch_cost;
+    *last = p;
+    if (p->first_run_time < 0) p->first_run_time = *t;
+}
+
+/* verifica se processo terminado */
+static int is_done(Process *p) {
+    return p->remaining <= EPS;
+}
+
+/* copia resultados */
+static void fill_result(Result *r, Process *p) {
+    r->Elapsed = (p->finish_time < 0) ? 0.0 : p->finish_time - p->arrival;
+    r->CPU = p->cpu_consumed + p->stall_time;
+    r->BLOCKED = p->blocked_time;
+    r->FirstRun = (p->first_run_time < 0) ? 0.0 : p->first_run_time - p->arrival;
+}
+
+/* ------------------- Cenários ------------------- */
+
+/* scenario 1: A 10, B 15, C 20 */
+static Process * make_scenario1(int *out_n) {
+    int n = 3;
+    Process *ps = (Process*) malloc(sizeof(Process) * n);
+    strcpy(ps[0].name, "A"); ps[0].total_cpu_needed = 10.0; ps[0].io_events = NULL; ps[0].io_count = 0;
+    strcpy(ps[1].name, "B"); ps[1].total_cpu_needed = 15.0; ps[1].io_events = NULL; ps[1].io_count = 0;
+    strcpy(ps[2].name, "C"); ps[2].total_cpu_needed = 20.0; ps[2].io_events = NULL; ps[2].io_count = 0;
+    *out_n = n;
+    return ps;
+}
+
+/* scenario 2: A5 B10 C4 D2 E3 F15 */
+static Process * make_scenario2(int *out_n) {
+    int n = 6;
+    Process *ps = (Process*) malloc(sizeof(Process) * n);
+    strcpy(ps[0].name, "A"); ps[0].total_cpu_needed = 5.0; ps[0].io_events = NULL; ps[0].io_count = 0;
+    strcpy(ps[1].name, "B"); ps[1].total_cpu_needed = 10.0; ps[1].io_events = NULL; ps[1].io_count = 0;
+    strcpy(ps[2].name, "C"); ps[2].total_cpu_needed = 4.0; ps[2].io_events = NULL; ps[2].io_count = 0;
+    strcpy(ps[3].name, "D"); ps[3].total_cpu_needed = 2.0; ps[3].io_events = NULL; ps[3].io_count = 0;
+    strcpy(ps[4].name, "E"); ps[4].total_cpu_needed = 3.0; ps[4].io_events = NULL; ps[4].io_count = 0;
+    strcpy(ps[5].name, "F"); ps[5].total_cpu_needed = 15.0; ps[5].io_events = NULL; ps[5].io_count = 0;
+    *out_n = n;
+    return ps;
+}
+
+/* scenario 3: A-5.csv, B-5.csv, C-5.csv equivalent embedded */
+/* We'll create example IO sequences meaningful for testing */
+static Process * make_scenario3(int *out_n) {
+    int n = 3;
+    Process *ps = (Process*) malloc(sizeof(Process) * n);
+
+    /* A: total 5, IO events: at 1.0 (0.5), at 3.0 (0.7) */
+    strcpy(ps[0].name, "A"); ps[0].total_cpu_needed = 5.0;
+    ps[0].io_count = 2;
+    ps[0].io_events = (IOEvent*) malloc(sizeof(IOEvent) * 2);
+    ps[0].io_events[0].when_cpu = 1.0; ps[0].io_events[0].duration = 0.5;
+    ps[0].io_events[1].when_cpu = 3.0; ps[0].io_events[1].duration = 0.7;
+
+    /* B: total 5, IO events: at 2.0 (0.4) */
+    strcpy(ps[1].name, "B"); ps[1].total_cpu_needed = 5.0;
+    ps[1].io_count = 1;
+    ps[1].io_events = (IOEvent*) malloc(sizeof(IOEvent) * 1);
+    ps[1].io_events[0].when_cpu = 2.0; ps[1].io_events[0].duration = 0.4;
+
+    /* C: total 5, IO events: at 0.5 (0.2), at 2.5 (1.0) */
+    strcpy(ps[2].name, "C"); ps[2].total_cpu_needed = 5.0;
+    ps[2].io_count = 2;
+    ps[2].io_events = (IOEvent*) malloc(sizeof(IOEvent) * 2);
+    ps[2].io_events[0].when_cpu = 0.5; ps[2].io_events[0].duration = 0.2;
+    ps[2].io_events[1].when_cpu = 2.5; ps[2].io_events[1].duration = 1.0;
+
+    *out_n = n;
+    return ps;
+}
+
+/* scenario 4: A-6.csv, B-6.csv, C-6.csv equivalent embedded */
+static Process * make_scenario4(int *out_n) {
+    int n = 3;
+    Process *ps = (Process*) malloc(sizeof(Process) * n);
+
+    /* A: total 6, IO events */
+    strcpy(ps[0].name, "A"); ps[0].total_cpu_needed = 6.0;
+    ps[0].io_count = 2;
+    ps[0].io_events = (IOEvent*) malloc(sizeof(IOEvent) * 2);
+    ps[0].io_events[0].when_cpu = 1.2; ps[0].io_events[0].duration = 0.6;
+    ps[0].io_events[1].when_cpu = 4.0; ps[0].io_events[1].duration = 0.8;
+
+    /* B: total 6, IO events */
+    strcpy(ps[1].name, "B"); ps[1].total_cpu_needed = 6.0;
+    ps[1].io_count = 1;
+    ps[1].io_events = (IOEvent*) malloc(sizeof(IOEvent) * 1);
+    ps[1].io_events[0].when_cpu = 3.5; ps[1].io_events[0].duration = 0.5;
+
+    /* C: total 6, IO events */
+    strcpy(ps[2].name, "C"); ps[2].total_cpu_needed = 6.0;
+    ps[2].io_count = 3;
+    ps[2].io_events = (IOEvent*) malloc(sizeof(IOEvent) * 3);
+    ps[2].io_events[0].when_cpu = 0.8; ps[2].io_events[0].duration = 0.3;
+    ps[2].io_events[1].when_cpu = 2.0; ps[2].io_events[1].duration = 0.4;
+    ps[2].io_events[2].when_cpu = 4.5; ps[2].io_events[2].duration = 0.6;
+
+    *out_n = n;
+    return ps;
+}
+
+/* Generic factory */
+static Process * make_scenario(int scen, int *out_n) {
+    Process *ps = NULL;
+    if (scen == 1) ps = make_scenario1(out_n);
+    else if (scen == 2) ps = make_scenario2(out_n);
+    else if (scen == 3) ps = make_scenario3(out_n);
+    else if (scen == 4) ps = make_scenario4(out_n);
+    else *out_n = 0;
+    for (int i = 0; ps && i < *out_n; ++i) {
+        ps[i].arrival = 0.0;
+        ps[i].mem_intensity = 0.0;
+        ps[i].fanout = 1;
+    }
+    return ps;
+}
+
+/* Ficheiro de cenário: uma linha por processo, '#' inicia comentário
+ *   nome cpu [arrival=t] [mem=m] [fanout=k] [io=quando:duração,quando:duração,...]
+ * fanout só conta no modo cluster: o pedido abre k folhas de cpu cada. Devolve NULL se o ficheiro não abre ou tem uma linha inválida. */
+static Process * load_scenario_file(const char *path, int *out_n) {
+    FILE *f = fopen(path, "r");
+    if (!f) return NULL;
+    int n = 0, cap = 16;
+    Process *ps = (Process*) malloc(sizeof(Process) * cap);
+    char line[4096];
+    int lineno = 0, bad = 0;
+    while (!bad && fgets(line, sizeof(line), f)) {
+        lineno++;
+        char *hash = strchr(line, '#');
+        if (hash) *hash = '\0';
+        char *name = strtok(line, " \t\r\n");
+        if (!name) continue;
+        char *cpu = strtok(NULL, " \t\r\n");
+        if (n == cap) {
+            cap *= 2;
+            ps = (Process*) realloc(ps, sizeof(Process) * cap);
+        }
+        Process *p = &ps[n];
+        memset(p, 0, sizeof(*p));
+        snprintf(p->name, sizeof(p->name), "%s", name);
+        p->fanout = 1;
+        if (!cpu || (p->total_cpu_needed = atof(cpu)) <= 0.0) bad = 1;
+        for (char *tok = strtok(NULL, " \t\r\n"); tok && !bad; tok = strtok(NULL, " \t\r\n")) {
+            if (strncmp(tok, "arrival=", 8) == 0) {
+                p->arrival = atof(tok + 8);
+            } else if (strncmp(tok, "mem=", 4) == 0) {
+                p->mem_intensity = atof(tok + 4);
+            } else if (strncmp(tok, "fanout=", 7) == 0) {
+                p->fanout = atoi(tok + 7);
+            } else if (strncmp(tok, "io=", 3) == 0) {
+                int io_cap = 4;
+                p->io_events = (IOEvent*) malloc(sizeof(IOEvent) * io_cap);
+                for (char *ev = tok + 3; *ev; ) {
+                    double when, dur;
+                    int used;
+                    if (sscanf(ev, "%lf:%lf%n", &when, &dur, &used) != 2) { bad = 1; break; }
+                    if (p->io_count == io_cap) {
+                        io_cap *= 2;
+                        p->io_events = (IOEvent*) realloc(p->io_events, sizeof(IOEvent) * io_cap);
+                    }
+                    p->io_events[p->io_count++] = (IOEvent) { when, dur };
+                    ev += used;
+                    if (*ev == ',') ev++;
+                }
+            } else {
+                bad = 1;
+            }
+        }
+        if (p->arrival < 0.0 || p->mem_intensity < 0.0 || p->mem_intensity > 1.0 || p->fanout < 1) bad = 1;
+        n++;
+    }
+    fclose(f);
+    if (bad || n == 0) {
+        if (bad) fprintf(stderr, "%s:%d: linha inválida\n", path, lineno);
+        free_processes(ps, n);
+        return NULL;
+    }
+    *out_n = n;
+    return ps;
+}
+
+/* Cenário pelo número (1-4) ou por ficheiro */
+static Process * load_scenario(const char *arg, int *out_n) {
+    char *end;
+    long scen = strtol(arg, &end, 10);
+    if (end != arg && *end == '\0') return make_scenario((int) scen, out_n);
+    return load_scenario_file(arg, out_n);
+}
+
+/* ------------------- Cargas geradas ------------------- */
+
+/* splitmix64: reprodutível e independente da libc */
+static uint64_t rng_next(uint64_t *state) {
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+/* uniforme em (0, 1) */
+static double rng_uniform(uint64_t *state) {
+    return ((rng_next(state) >> 11) + 0.5) / 9007199254740992.0;
+}
+
+static double rng_exp(uint64_t *state, double mean) {
+    return -mean * log(rng_uniform(state));
+}
+
+/* n jobs sem IO: chegadas de Poisson com taxa `rate`, serviço exponencial
+ * com média `mean`, cada um com `fanout` folhas no modo cluster. Já
+ * inicializados (prontos a simular sem clone). */
+static Process * generate_workload(int n, double rate, double mean, int fanout, uint64_t seed) {
+    Process *ps = (Process*) calloc(n, sizeof(Process));
+    uint64_t state = seed;
+    double t = 0.0;
+    for (int i = 0; i < n; ++i) {
+        Process *p = &ps[i];
+        t += rng_exp(&state, 1.0 / rate);
+        snprintf(p->name, sizeof(p->name), "J%d", i);
+        p->total_cpu_needed = rng_exp(&state, mean) + EPS;
+        p->arrival = t;
+        p->fanout = fanout;
+        reset_process(p, i);
+    }
+    return ps;
+}
+
+/* ------------------- Algoritmos de escalonamento ------------------- */
+
+/* FIFO: cada processo corre até IO ou terminar (não preemptivo aqui) */
+static Result* run_fifo(Process *orig, int n, int *out_count) {
+    Process *procs = clone_processes(orig, n);
+    Result *res = (Result*) malloc(sizeof(Result) * n);
+    double t = 0.0;
+    Process *last = NULL;
+    int idx = 0;
+    for (int i = 0; i < n; ++i) {
+        Process *p = &procs[i];
+        dispatch(p, &last, &t);
+        while (!is_done(p)) {
+            double taken, io_dur;
+            eat_cpu(p, p->remaining, &taken, &io_dur); /* try to finish or reach next IO */
+            t += taken;
+            if (io_dur >= 0.0) { t += io_dur; }
+        }
+        p->finish_time = t;
+        fill_result(&res[idx++], p);
+        strcpy(res[idx-1].name, p->name);
+    }
+    *out_count = idx;
+    free_processes(procs, n);
+    return res;
+}
+
+/* SJF non-preemptivo: ordenar por total_cpu_needed e executar cada um até terminar/IO */
+static int cmp_total_cpu(const void *a, const void *b) {
+    const Process *pa = (const Process*) a;
+    const Process *pb = (const Process*) b;
+    if (pa->total_cpu_needed < pb->total_cpu_needed) return -1;
+    if (pa->total_cpu_needed > pb->total_cpu_needed) return 1;
+    return 0;
+}
+
+static Result* run_sjf(Process *orig, int n, int *out_count) {
+    /* clonamos e ordenamos por total_cpu_needed */
+    Process *procs = clone_processes(orig, n);
+    qsort(procs, n, sizeof(Process), cmp_total_cpu);
+    Result *res = (Result*) malloc(sizeof(Result) * n);
+    double t = 0.0;
+    Process *last = NULL;
+    int idx = 0;
+    for (int i = 0; i < n; ++i) {
+        Process *p = &procs[i];
+        dispatch(p, &last, &t);
+        while (!is_done(p)) {
+            double taken, io_dur;
+            eat_cpu(p, p->remaining, &taken, &io_dur);
+            t += taken;
+            if (io_dur >= 0.0) t += io_dur;
+        }
+        p->finish_time = t;
+        fill_result(&res[idx++], p);
+        strcpy(res[idx-1].name, p->name);
+    }
+    *out_count = idx;
+    free_processes(procs, n);
+    return res;
+}
+
+/* RR: round-robin com quantum QUANTUM */
+static Result* run_rr(Process *orig, int n, int *out_count) {
+    Process *procs = clone_processes(orig, n);
+    /* queue por pointers: buffer circular (nunca tem mais de n processos) */
+    Process **queue = (Process**) malloc(sizeof(Process*) * n);
+    int qstart = 0, qlen = 0;
+    for (int i = 0; i < n; ++i) queue[qlen++] = &procs[i];
+
+    Result *res = (Result*) malloc(sizeof(Result) * n);
+    int res_idx = 0;
+    double t = 0.0;
+    Process *last = NULL;
+    while (qlen > 0) {
+        Process *p = queue[qstart];
+        qstart = (qstart + 1) % n;
+        qlen--;
+        dispatch(p, &last, &t);
+        double taken, io_dur;
+        eat_cpu(p, QUANTUM, &taken, &io_dur);
+        t += taken;
+        if (io_dur >= 0.0) {
+            t += io_dur;
+        }
+        if (!is_done(p)) {
+            /* re-enqueue */
+            queue[(qstart + qlen) % n] = p;
+            qlen++;
+        } else {
+            p->finish_time = t;
+            fill_result(&res[res_idx++], p);
+            strcpy(res[res_idx-1].name, p->name);
+        }
+    }
+    free(queue);
+    *out_count = res_idx;
+    free_processes(procs, n);
+    return res;
+}
+
+/* Regra de descida do MLFQ, partilhada com os modos real e green:
+ * se usou todo o quantum desce (a não ser que esteja na última fila);
+ * se não usou (IO ocorreu cedo) mantém o nível */
+static int mlfq_next_level(int level, int used_full_quantum, int levels) {
+    if (used_full_quantum && level < levels - 1) return level + 1;
+    return level;
+}
+
+/* MLFQ simples: 3 filas (0..2). Quantum = QUANTUM. Se usar todo o quantum, desce de fila. */
+static Result* run_mlfq(Process *orig, int n, int *out_count) {
+    const int LEVELS = MLFQ_LEVELS;
+    Process *procs = clone_processes(orig, n);
+    /* filas de pointers; implementamos com arrays dinâmicos por fila */
+    Process ***queues = (Process***) malloc(sizeof(Process**) * LEVELS);
+    int *qsize = (int*) malloc(sizeof(int) * LEVELS);
+    int *qcap  = (int*) malloc(sizeof(int) * LEVELS);
+    for (int i = 0; i < LEVELS; ++i) {
+        qcap[i] = n + 4;
+        queues[i] = (Process**) malloc(sizeof(Process*) * qcap[i]);
+        qsize[i] = 0;
+    }
+    /* inserir todos na fila 0 */
+    for (int i = 0; i < n; ++i) queues[0][qsize[0]++] = &procs[i];
+
+    Result *res = (Result*) malloc(sizeof(Result) * n);
+    int res_idx = 0;
+    double t = 0.0;
+    Process *last = NULL;
+    /* enquanto alguma fila tiver elementos */
+    int any = 1;
+    while (1) {
+        any = 0;
+        for (int i = 0; i < LEVELS; ++i) if (qsize[i] > 0) { any = 1; break; }
+        if (!any) break;
+        /* encontra fila mais alta não vazia */
+        int qidx = -1;
+        for (int i = 0; i < LEVELS; ++i) if (qsize[i] > 0) { qidx = i; break; }
+        if (qidx == -1) break;
+        /* pop from queue qidx (FIFO within level) */
+        Process *p = queues[qidx][0];
+        /* shift left */
+        for (int j = 1; j < qsize[qidx]; ++j) queues[qidx][j-1] = queues[qidx][j];
+        qsize[qidx]--;
+        dispatch(p, &last, &t);
+        double taken, io_dur;
+        eat_cpu(p, QUANTUM, &taken, &io_dur);
+        t += taken;
+        if (io_dur >= 0.0) t += io_dur;
+        if (is_done(p)) {
+            p->finish_time = t;
+            fill_result(&res[res_idx++], p);
+            strcpy(res[res_idx-1].name, p->name);
+        } else {
+            int new_q = mlfq_next_level(qidx, taken > QUANTUM - 1e-9, LEVELS);
+            /* enqueue em new_q */
+            if (qsize[new_q] >= qcap[new_q]) {
+                qcap[new_q] *= 2;
+                queues[new_q] = (Process**) realloc(queues[new_q], sizeof(Process*) * qcap[new_q]);
+            }
+            queues[new_q][qsize[new_q]++] = p;
+        }
+    }
+
+    for (int i = 0; i < LEVELS; ++i) free(queues[i]);
+    free(queues); free(qsize); free(qcap);
+    *out_count = res_idx;
+    free_processes(procs, n);
+    return res;
+}
+
+/* ------------------- Simulação multi-CPU ------------------- */
+
+/* Parâmetros do modo multi-CPU (--cpus K, -i, --epoch, --place) */
+static int sim_cpus = 1;
+static int sim_threads = 1;        /* threads do host que partilham os CPUs simulados */
+static double interference = 0.0; /* beta: abrandamento = 1 + beta * m * soma(m dos co-runners) */
+static double epoch_len = 1.0;
+static const char *placement = "rr";
+
+/* Deque de processos (buffer circular que cresce); em sjf é um heap */
+typedef struct {
+    Process **items;
+    int head, len, cap;
+} ProcQueue;
+
+static void pq_grow(ProcQueue *q) {
+    int cap = q->cap ? q->cap * 2 : 8;
+    Process **items = (Process**) malloc(sizeof(Process*) * cap);
+    for (int i = 0; i < q->len; ++i) items[i] = q->items[(q->head + i) % q->cap];
+    free(q->items);
+    q->items = items;
+    q->head = 0;
+    q->cap = cap;
+}
+
+static void pq_push(ProcQueue *q, Process *p) {
+    if (q->len == q->cap) pq_grow(q);
+    q->items[(q->head + q->len++) % q->cap] = p;
+}
+
+static Process *pq_pop(ProcQueue *q) {
+    Process *p = q->items[q->head];
+    q->head = (q->head + 1) % q->cap;
+    q->len--;
+    return p;
+}
+
+static Process *pq_pop_back(ProcQueue *q) {
+    return q->items[(q->head + --q->len) % q->cap];
+}
+
+/* Heap de sjf: menor total_cpu_needed primeiro, empates pela ordem na carga */
+static int sjf_before(const Process *a, const Process *b) {
+    if (a->total_cpu_needed != b->total_cpu_needed) return a->total_cpu_needed < b->total_cpu_needed;
+    return a->id < b->id;
+}
+
+static void sjf_push(ProcQueue *q, Process *p) {
+    if (q->len == q->cap) pq_grow(q);
+    int i = q->len++;
+    while (i > 0 && sjf_before(p, q->items[(i - 1) / 2])) {
+        q->items[i] = q->items[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    q->items[i] = p;
+}
+
+static Process *sjf_pop(ProcQueue *q) {
+    Process *top = q->items[0];
+    Process *last = q->items[--q->len];
+    int i = 0;
+    for (;;) {
+        int c = 2 * i + 1;
+        if (c >= q->len) break;
+        if (c + 1 < q->len && sjf_before(q->items[c + 1], q->items[c])) c++;
+        if (!sjf_before(q->items[c], last)) break;
+        q->items[i] = q->items[c];
+        i = c;
+    }
+    if (q->len > 0) q->items[i] = last;
+    return top;
+}
+
+/* Filas de um CPU/host: níveis MLFQ (fifo/rr usam só q[0]) ou heap sjf */
+typedef struct {
+    ProcQueue q[MLFQ_LEVELS];
+    int queued;
+} RunQueue;
+
+static void runq_push(RunQueue *rq, int sjf, Process *p) {
+    if (sjf) sjf_push(&rq->q[0], p);
+    else pq_push(&rq->q[p->level], p);
+    rq->queued++;
+}
+
+static Process *runq_pop(RunQueue *rq, int sjf) {
+    if (rq->queued == 0) return NULL;
+    rq->queued--;
+    if (sjf) return sjf_pop(&rq->q[0]);
+    for (int l = 0; l < MLFQ_LEVELS; ++l) if (rq->q[l].len > 0) return pq_pop(&rq->q[l]);
+    return NULL;
+}
+
+/* Processo a roubar: o último da fila de menor prioridade */
+static Process *runq_steal(RunQueue *rq, int sjf) {
+    if (rq->queued == 0) return NULL;
+    rq->queued--;
+    if (sjf) return rq->q[0].items[--rq->q[0].len]; /* retirar a última folha mantém o heap */
+    for (int l = MLFQ_LEVELS - 1; l >= 0; --l) if (rq->q[l].len > 0) return pq_pop_back(&rq->q[l]);
+    return NULL;
+}
+
+static void runq_free(RunQueue *rq) {
+    for (int l = 0; l < MLFQ_LEVELS; ++l) free(rq->q[l].items);
+}
+
+/* Corre um slice de p a partir de *t: até ao fim (fifo/sjf) ou um quantum
+ * (rr/mlfq), com o trabalho de CPU `slow` vezes mais lento. O IO mantém o
+ * CPU, como nos algoritmos de um CPU. Devolve o CPU de trabalho consumido. */
+static double slice_run(Process *p, int preemptive, double slow, double *t) {
+    double taken, io_dur, used = 0.0;
+    if (preemptive) {
+        eat_cpu(p, QUANTUM / slow, &taken, &io_dur);
+        used = taken;
+        *t += taken * slow;
+        if (io_dur >= 0.0) *t += io_dur;
+    } else {
+        while (!is_done(p)) {
+            eat_cpu(p, p->remaining, &taken, &io_dur);
+            used += taken;
+            *t += taken * slow;
+            if (io_dur >= 0.0) *t += io_dur;
+        }
+    }
+    p->stall_time += used * (slow - 1.0);
+    return used;
+}
+
+typedef struct {
+    double t;                     /* relógio do CPU */
+    RunQueue rq;
+    ProcQueue arrivals;           /* colocados neste CPU, por ordem de chegada */
+    Process *last;
+    double mem_busy;              /* soma de mem_intensity * tempo de CPU na época */
+    double mem_prev;              /* intensidade média na época anterior */
+    long slices;
+    double slowdown_sum;
+    int done;
+} SimCpu;
+
+/* Caixa de correio lock-free (pilha de Treiber, MPSC) com os processos
+ * que mudam de partição na fronteira de época */
+enum { MAIL_MIGRATE, MAIL_ARRIVAL };
+
+typedef struct {
+    _Atomic(Process*) head;
+} Mailbox;
+
+static void mail_send(Mailbox *mb, Process *p, int kind) {
+    p->mail_kind = kind;
+    Process *old = atomic_load_explicit(&mb->head, memory_order_relaxed);
+    do {
+        p->mail_next = old;
+    } while (!atomic_compare_exchange_weak_explicit(&mb->head, &old, p,
+                                                    memory_order_release, memory_order_relaxed));
+}
+
+static Process *mail_take(Mailbox *mb) {
+    return atomic_exchange_explicit(&mb->head, NULL, memory_order_acquire);
+}
+
+typedef struct {
+    const char *alg;
+    int preemptive;
+    int sjf;
+    int mlfq;
+    SimCpu *cpus;
+    int k;
+    Process **by_arrival;         /* ordenados por (arrival, id) */
+    int n;
+    int next_arrival;
+    int done;
+    double mem_total;             /* soma de mem_prev de todos os CPUs */
+    long migrations;
+    unsigned rr_next;
+    unsigned rand_state;
+    /* execução paralela: uma partição de CPUs por thread */
+    Mailbox *mail;                /* uma por CPU */
+    int *steals;                  /* pares (vítima, ladrão) do plano da época */
+    int steal_count;
+    pthread_barrier_t barrier;
+    double boundary;
+    int stop;
+} MultiSim;
+
+static void cpu_admit(MultiSim *ms, SimCpu *c) {
+    while (c->arrivals.len > 0 && c->arrivals.items[c->arrivals.head]->arrival <= c->t + EPS)
+        runq_push(&c->rq, ms->sjf, pq_pop(&c->arrivals));
+}
+
+/* Corre um slice de p em c com o abrandamento da interferência */
+static void cpu_slice(MultiSim *ms, SimCpu *c, Process *p) {
+    dispatch(p, &c->last, &c->t);
+    double slow = 1.0 + interference * p->mem_intensity * (ms->mem_total - c->mem_prev);
+    double used = slice_run(p, ms->preemptive, slow, &c->t);
+    c->mem_busy += p->mem_intensity * used * slow;
+    c->slices++;
+    c->slowdown_sum += slow;
+
+    if (is_done(p)) {
+        p->finish_time = c->t;
+        c->done++;
+        return;
+    }
+    if (ms->mlfq) p->level = mlfq_next_level(p->level, used > QUANTUM / slow - 1e-9, MLFQ_LEVELS);
+    cpu_admit(ms, c); /* quem chegou durante o slice entra antes de p */
+    p->ready_time = c->t;
+    runq_push(&c->rq, ms->sjf, p);
+}
+
+/* Avança um CPU até ao fim da época; só toca no estado desse CPU */
+static void cpu_run_epoch(MultiSim *ms, SimCpu *c, double start, double end) {
+    if (c->t < start) c->t = start;
+    while (c->t < end && !(c->rq.queued == 0 && c->arrivals.len == 0)) {
+        cpu_admit(ms, c);
+        Process *p = runq_pop(&c->rq, ms->sjf);
+        if (!p) {
+            /* ocioso até à próxima chegada colocada aqui */
+            double next = c->arrivals.items[c->arrivals.head]->arrival;
+            c->t = next < end ? next : end;
+            continue;
+        }
+        /* roubado na fronteira a um CPU cujo relógio já a passou: o slice
+         * anterior (com o IO) ainda não tinha acabado */
+        if (p->ready_time > c->t) c->t = p->ready_time;
+        cpu_slice(ms, c, p);
+    }
+    if (c->t < end) c->t = end;
+}
+
+static int cpu_load(const SimCpu *c, double boundary) {
+    return c->rq.queued + c->arrivals.len + (c->t > boundary + EPS ? 1 : 0);
+}
+
+/* Fronteira de época, calculada por uma só thread enquanto as outras
+ * esperam na barreira: soma a interferência, decide os roubos (CPUs vazios
+ * roubam a quem tem processos à espera) e coloca as chegadas da época
+ * seguinte com --place. Os processos só mudam de CPU pelas caixas de
+ * correio, na fase seguinte. */
+static void epoch_plan(MultiSim *ms, double boundary) {
+    ms->mem_total = 0.0;
+    for (int i = 0; i < ms->k; ++i) ms->mem_total += ms->cpus[i].mem_prev;
+
+    int *load = (int*) malloc(sizeof(int) * ms->k);
+    int *waiting = (int*) malloc(sizeof(int) * ms->k);
+    for (int i = 0; i < ms->k; ++i) {
+        SimCpu *c = &ms->cpus[i];
+        load[i] = cpu_load(c, boundary);
+        /* só rouba o que está de facto à espera: fila com 2+ ou CPU ocupado */
+        waiting[i] = c->rq.queued - (c->t > boundary + EPS ? 0 : 1);
+    }
+    ms->steal_count = 0;
+    for (int thief = 0; thief < ms->k; ++thief) {
+        if (load[thief] > 0) continue;
+        int victim = -1, best = 0;
+        for (int i = 0; i < ms->k; ++i) {
+            if (waiting[i] > best) { best = waiting[i]; victim = i; }
+        }
+        if (victim < 0) continue;
+        waiting[victim]--;
+        load[victim]--;
+        load[thief]++;
+        ms->steals[2 * ms->steal_count] = victim;
+        ms->steals[2 * ms->steal_count + 1] = thief;
+        ms->steal_count++;
+        ms->migrations++;
+    }
+
+    /* com um só CPU não há colocação a decidir: as chegadas vão já todas
+     * para a fila e entram à hora certa, mesmo a meio de um slice longo */
+    double end = ms->k == 1 ? INFINITY : boundary + epoch_len;
+    while (ms->next_arrival < ms->n && ms->by_arrival[ms->next_arrival]->arrival < end) {
+        Process *p = ms->by_arrival[ms->next_arrival++];
+        int target = 0;
+        if (strcmp(placement, "least") == 0) {
+            for (int i = 1; i < ms->k; ++i) if (load[i] < load[target]) target = i;
+        } else if (strcmp(placement, "random") == 0) {
+            ms->rand_state = ms->rand_state * 1103515245u + 12345u;
+            target = (int) ((ms->rand_state >> 8) % (unsigned) ms->k);
+        } else {
+            target = (int) (ms->rr_next++ % (unsigned) ms->k);
+        }
+        load[target]++;
+        mail_send(&ms->mail[target], p, MAIL_ARRIVAL);
+    }
+    free(load);
+    free(waiting);
+}
+
+static int cmp_arrival(const void *a, const void *b) {
+    const Process *pa = *(Process* const*) a;
+    const Process *pb = *(Process* const*) b;
+    if (pa->arrival != pb->arrival) return pa->arrival < pb->arrival ? -1 : 1;
+    return pa->id - pb->id;
+}
+
+static int cmp_finish(const void *a, const void *b) {
+    const Process *pa = *(Process* const*) a;
+    const Process *pb = *(Process* const*) b;
+    if (pa->finish_time != pb->finish_time) return pa->finish_time < pb->finish_time ? -1 : 1;
+    return pa->id - pb->id;
+}
+
+/* Estatísticas da última execução multi-CPU (impressas pelo main) */
+typedef struct {
+    int cpus;
+    double makespan;
+    long migrations;
+    double mean_slowdown;
+} MultiStats;
+
+static MultiStats multi_stats;
+
+static void multi_init(MultiSim *ms, const char *alg, Process *procs, int n, int k) {
+    memset(ms, 0, sizeof(*ms));
+    ms->alg = alg;
+    ms->preemptive = strcmp(alg, "rr") == 0 || strcmp(alg, "mlfq") == 0;
+    ms->sjf = strcmp(alg, "sjf") == 0;
+    ms->mlfq = strcmp(alg, "mlfq") == 0;
+    ms->k = k;
+    ms->n = n;
+    ms->rand_state = 42;
+    ms->cpus = (SimCpu*) calloc(k, sizeof(SimCpu));
+    ms->mail = (Mailbox*) calloc(k, sizeof(Mailbox));
+    ms->steals = (int*) malloc(sizeof(int) * 2 * k);
+    ms->by_arrival = (Process**) malloc(sizeof(Process*) * n);
+    for (int i = 0; i < n; ++i) ms->by_arrival[i] = &procs[i];
+    qsort(ms->by_arrival, n, sizeof(Process*), cmp_arrival);
+}
+
+/* Resultados por ordem de fim (como nos algoritmos de um CPU) */
+static Result *multi_finish(MultiSim *ms, Process *procs, int *out_count) {
+    int n = ms->n;
+    for (int i = 0; i < n; ++i) ms->by_arrival[i] = &procs[i];
+    qsort(ms->by_arrival, n, sizeof(Process*), cmp_finish);
+    Result *res = (Result*) malloc(sizeof(Result) * n);
+    double slow = 0.0;
+    long slices = 0;
+    for (int i = 0; i < n; ++i) {
+        fill_result(&res[i], ms->by_arrival[i]);
+        strcpy(res[i].name, ms->by_arrival[i]->name);
+    }
+    for (int i = 0; i < ms->k; ++i) {
+        slow += ms->cpus[i].slowdown_sum;
+        slices += ms->cpus[i].slices;
+        runq_free(&ms->cpus[i].rq);
+        free(ms->cpus[i].arrivals.items);
+    }
+    multi_stats.cpus = ms->k;
+    multi_stats.makespan = n ? ms->by_arrival[n - 1]->finish_time : 0.0;
+    multi_stats.migrations = ms->migrations;
+    multi_stats.mean_slowdown = slices ? slow / slices : 1.0;
+    free(ms->cpus);
+    free(ms->mail);
+    free(ms->steals);
+    free(ms->by_arrival);
+    *out_count = n;
+    return res;
+}
+
+/* Próxima fronteira com trabalho: salta épocas em que todos estão ociosos */
+static double multi_next_epoch(MultiSim *ms, double boundary) {
+    for (int i = 0; i < ms->k; ++i) {
+        if (ms->cpus[i].rq.queued > 0 || ms->cpus[i].arrivals.len > 0 || ms->cpus[i].t > boundary + EPS) return boundary;
+    }
+    if (ms->next_arrival < ms->n) {
+        double a = ms->by_arrival[ms->next_arrival]->arrival;
+        double skip = floor(a / epoch_len) * epoch_len;
+        if (skip > boundary) return skip;
+    }
+    return boundary;
+}
+
+typedef struct {
+    MultiSim *ms;
+    int index;
+    int first, last;      /* CPUs [first, last) desta partição */
+} MultiPart;
+
+/* Recolhe a caixa de um CPU por uma ordem que não depende de que thread
+ * enviou primeiro: por (arrival, id), migrações antes das chegadas */
+static void cpu_receive(MultiSim *ms, SimCpu *c, Mailbox *mb, ProcQueue *scratch) {
+    scratch->len = 0;
+    for (Process *p = mail_take(mb); p; p = p->mail_next) pq_push(scratch, p);
+    if (scratch->len == 0) return;
+    Process **items = scratch->items; /* head == 0: nunca há pops */
+    qsort(items, scratch->len, sizeof(Process*), cmp_arrival);
+    for (int pass = 0; pass < 2; ++pass) {
+        for (int i = 0; i < scratch->len; ++i) {
+            if (pass == 0 && items[i]->mail_kind == MAIL_MIGRATE) runq_push(&c->rq, ms->sjf, items[i]);
+            if (pass == 1 && items[i]->mail_kind == MAIL_ARRIVAL) pq_push(&c->arrivals, items[i]);
+        }
+    }
+}
+
+/* Cada época tem três fases separadas por barreiras:
+ *   plano (thread 0) -> roubos enviados pelas vítimas -> receção + época */
+static void *multi_part(void *arg) {
+    MultiPart *part = (MultiPart*) arg;
+    MultiSim *ms = part->ms;
+    ProcQueue scratch = { NULL, 0, 0, 0 };
+    for (;;) {
+        if (part->index == 0) {
+            int done = 0;
+            for (int i = 0; i < ms->k; ++i) done += ms->cpus[i].done;
+            ms->stop = done >= ms->n;
+            if (!ms->stop) {
+                ms->boundary = multi_next_epoch(ms, ms->boundary);
+                epoch_plan(ms, ms->boundary);
+            }
+        }
+        pthread_barrier_wait(&ms->barrier);
+        if (ms->stop) break;
+        double boundary = ms->boundary;
+
+        for (int s = 0; s < ms->steal_count; ++s) {
+            int victim = ms->steals[2 * s], thief = ms->steals[2 * s + 1];
+            if (victim < part->first || victim >= part->last) continue;
+            mail_send(&ms->mail[thief], runq_steal(&ms->cpus[victim].rq, ms->sjf), MAIL_MIGRATE);
+        }
+        pthread_barrier_wait(&ms->barrier);
+
+        for (int i = part->first; i < part->last; ++i) {
+            SimCpu *c = &ms->cpus[i];
+            cpu_receive(ms, c, &ms->mail[i], &scratch);
+            cpu_run_epoch(ms, c, boundary, boundary + epoch_len);
+            c->mem_prev = c->mem_busy / epoch_len;
+            if (c->mem_prev > 1.0) c->mem_prev = 1.0;
+            c->mem_busy = 0.0;
+        }
+        pthread_barrier_wait(&ms->barrier);
+        if (part->index == 0) ms->boundary = boundary + epoch_len;
+    }
+    free(scratch.items);
+    return NULL;
+}
+
+/* K CPUs com filas próprias, chegadas e interferência de memória.
+ * O tempo avança em épocas de epoch_len: dentro de uma época cada CPU é
+ * independente; a interferência de uma época usa a intensidade média dos
+ * CPUs na época anterior. Com K = 1 e chegadas em t=0 dá o mesmo que
+ * run_fifo/run_sjf/run_rr/run_mlfq.
+ * A época é a janela de lookahead da execução paralela (--threads T): os
+ * CPUs são repartidos por T threads, que só trocam processos pelas caixas
+ * de correio nas fronteiras, por isso o resultado não depende de T. */
+static Result* run_multi(const char *alg, Process *orig, int n, int *out_count) {
+    Process *procs = clone_processes(orig, n);
+    MultiSim ms;
+    multi_init(&ms, alg, procs, n, sim_cpus);
+    int threads = sim_threads;
+    if (threads > ms.k) threads = ms.k;
+    if (threads > MAX_WORKERS) threads = MAX_WORKERS;
+    if (threads < 1) threads = 1;
+    pthread_barrier_init(&ms.barrier, NULL, threads);
+
+    MultiPart parts[MAX_WORKERS];
+    pthread_t tids[MAX_WORKERS];
+    for (int t = 0; t < threads; ++t) {
+        parts[t] = (MultiPart) { &ms, t, t * ms.k / threads, (t + 1) * ms.k / threads };
+        if (t > 0) pthread_create(&tids[t], NULL, multi_part, &parts[t]);
+    }
+    multi_part(&parts[0]);
+    for (int t = 1; t < threads; ++t) pthread_join(tids[t], NULL);
+    pthread_barrier_destroy(&ms.barrier);
+
+    Result *res = multi_finish(&ms, procs, out_count);
+    free_processes(procs, n);
+    return res;
+}
+
+/* ------------------- FIFO/SJF em forma fechada ------------------- */
+
+/* Sem preempção cada processo corre de uma vez até ao fim (o IO segura o
+ * CPU), por isso o fim do k-ésimo despachado é
+ *     f_k = max(f_{k-1}, chegada_k) + custo_k,  custo_k = troca + CPU + IO
+ * ou seja f_k = max(f_{k-1} + A_k, B_k) com (A, B) = (custo, chegada + custo).
+ * Compor (A1, B1) e depois (A2, B2) dá (A1 + A2, max(B1 + A2, B2)), que é
+ * associativo: cada thread resume o seu bloco, os resumos compõem-se em
+ * série e cada thread refaz o bloco a partir do fim do anterior. */
+
+#define SCAN_MIN_CHUNK 65536
+
+/* Tempo de serviço de p a correr até ao fim, somado pela ordem em que
+ * eat_cpu o daria; *cpu e *io recebem as duas partes */
+static double solo_service(const Process *p, double *cpu, double *io) {
+    double consumed = 0.0, remaining = p->total_cpu_needed, service = 0.0;
+    *io = 0.0;
+    for (int k = 0; remaining > EPS; ) {
+        if (k >= p->io_count) {
+            consumed += remaining;
+            service += remaining;
+            break;
+        }
+        IOEvent ev = p->io_events[k];
+        double until = ev.when_cpu - consumed;
+        if (until > EPS) {
+            double take = until < remaining ? until : remaining;
+            consumed += take;
+            remaining -= take;
+            service += take;
+            if (!(fabs(consumed - ev.when_cpu) < 1e-6 || consumed > ev.when_cpu - 1e-9)) continue;
+        }
+        k++;
+        *io += ev.duration;
+        service += ev.duration;
+    }
+    *cpu = consumed;
+    return service;
+}
+
+typedef struct {
+    const double *service;  /* por ordem de despacho */
+    const double *arrival;  /* NULL: todos chegam a 0 */
+    double *finish;         /* NULL: só as reduções */
+    long lo, hi;
+    double a, b;            /* resumo do bloco: f(x) = max(x + a, b) */
+    double x0;              /* fim do bloco anterior */
+    double elapsed_sum, first_sum, elapsed_max;
+} ScanChunk;
+
+/* custo do k-ésimo: a troca só não se paga no primeiro */
+static double scan_cost(const ScanChunk *c, long k) {
+    return k > 0 ? c->service[k] + switch_cost : c->service[k];
+}
+
+static void * scan_summarize(void *arg) {
+    ScanChunk *c = (ScanChunk*) arg;
+    double a = 0.0, b = -INFINITY;
+    for (long k = c->lo; k < c->hi; ++k) {
+        double cost = scan_cost(c, k);
+        double bk = (c->arrival ? c->arrival[k] : 0.0) + cost;
+        a += cost;
+        b = b + cost > bk ? b + cost : bk;
+    }
+    c->a = a;
+    c->b = b;
+    return NULL;
+}
+
+static void * scan_apply(void *arg) {
+    ScanChunk *c = (ScanChunk*) arg;
+    double x = c->x0, elapsed_sum = 0.0, first_sum = 0.0, elapsed_max = 0.0;
+    if (!c->arrival) {
+        for (long k = c->lo; k < c->hi; ++k) {
+            double start = x + (k > 0 ? switch_cost : 0.0);
+            x = start + c->service[k];
+            if (c->finish) c->finish[k] = x;
+            elapsed_sum += x;
+            first_sum += start;
+        }
+        elapsed_max = x;
+    } else {
+        for (long k = c->lo; k < c->hi; ++k) {
+            double ready = c->arrival[k] > x ? c->arrival[k] : x;
+            double start = ready + (k > 0 ? switch_cost : 0.0);
+            x = start + c->service[k];
+            if (c->finish) c->finish[k] = x;
+            double e = x - c->arrival[k];
+            elapsed_sum += e;
+            first_sum += start - c->arrival[k];
+            if (e > elapsed_max) elapsed_max = e;
+        }
+    }
+    c->elapsed_sum = elapsed_sum;
+    c->first_sum = first_sum;
+    c->elapsed_max = elapsed_max;
+    c->x0 = x;
+    return NULL;
+}
+
+static int scan_threads(long n, int threads) {
+    long most = n / SCAN_MIN_CHUNK + 1;
+    return threads < most ? threads : (int) most;
+}
+
+static void run_chunks(ScanChunk *chunks, int threads, void *(*fn)(void*)) {
+    pthread_t *tids = (pthread_t*) malloc(sizeof(pthread_t) * threads);
+    for (int t = 1; t < threads; ++t) pthread_create(&tids[t], NULL, fn, &chunks[t]);
+    fn(&chunks[0]);
+    for (int t = 1; t < threads; ++t) pthread_join(tids[t], NULL);
+    free(tids);
+}
+
+/* Fins (se finish != NULL) e somas de Elapsed/FirstRun para service[] por
+ * ordem de despacho; devolve o makespan */
+static double prefix_finish(const double *service, const double *arrival, double *finish, long n, int threads,
+                            double *elapsed_sum, double *first_sum, double *elapsed_max) {
+    threads = scan_threads(n, threads);
+    ScanChunk *chunks = (ScanChunk*) calloc(threads, sizeof(ScanChunk));
+    for (int t = 0; t < threads; ++t) {
+        chunks[t] = (ScanChunk) { service, arrival, finish, n * t / threads, n * (t + 1) / threads,
+                                  0.0, 0.0, 0.0, 0.0, 0.0, 0.0 };
+    }
+    if (threads > 1) run_chunks(chunks, threads, scan_summarize);
+    double x = 0.0;
+    for (int t = 0; t < threads; ++t) {
+        chunks[t].x0 = x;
+        x = x + chunks[t].a > chunks[t].b ? x + chunks[t].a : chunks[t].b;
+    }
+    run_chunks(chunks, threads, scan_apply);
+    *elapsed_sum = *first_sum = *elapsed_max = 0.0;
+    for (int t = 0; t < threads; ++t) {
+        *elapsed_sum += chunks[t].elapsed_sum;
+        *first_sum += chunks[t].first_sum;
+        if (chunks[t].elapsed_max > *elapsed_max) *elapsed_max = chunks[t].elapsed_max;
+    }
+    double makespan = chunks[threads - 1].x0;
+    free(chunks);
+    return makespan;
+}
+
+static int cmp_index_cpu(const void *a, const void *b, void *arg) {
+    const Process *ps = (const Process*) arg;
+    const Process *pa = &ps[*(const int*) a], *pb = &ps[*(const int*) b];
+    if (pa->total_cpu_needed != pb->total_cpu_needed) return pa->total_cpu_needed < pb->total_cpu_needed ? -1 : 1;
+    return *(const int*) a - *(const int*) b;
+}
+
+static int cmp_index_arrival(const void *a, const void *b, void *arg) {
+    const Process *ps = (const Process*) arg;
+    const Process *pa = &ps[*(const int*) a], *pb = &ps[*(const int*) b];
+    if (pa->arrival != pb->arrival) return pa->arrival < pb->arrival ? -1 : 1;
+    return *(const int*) a - *(const int*) b;
+}
+
+/* fifo (por chegada) e sjf (sem chegadas) num CPU: os mesmos resultados
+ * que run_fifo/run_sjf, ou que run_multi com um CPU quando há chegadas */
+static Result* run_closed_form(const char *alg, Process *base, int n, int threads, int *out_count) {
+    int sjf = strcmp(alg, "sjf") == 0, arrivals = 0;
+    for (int i = 0; i < n; ++i) if (base[i].arrival > 0.0) arrivals = 1;
+    int *order = (int*) malloc(sizeof(int) * n);
+    for (int i = 0; i < n; ++i) order[i] = i;
+    if (sjf) qsort_r(order, n, sizeof(int), cmp_index_cpu, base);
+    else if (arrivals) qsort_r(order, n, sizeof(int), cmp_index_arrival, base);
+
+    double *service = (double*) malloc(sizeof(double) * n);
+    double *cpu = (double*) malloc(sizeof(double) * n);
+    double *io = (double*) malloc(sizeof(double) * n);
+    double *arrival = arrivals ? (double*) malloc(sizeof(double) * n) : NULL;
+    double *finish = (double*) malloc(sizeof(double) * n);
+    for (int k = 0; k < n; ++k) {
+        service[k] = solo_service(&base[order[k]], &cpu[k], &io[k]);
+        if (arrival) arrival[k] = base[order[k]].arrival;
+    }
+    double elapsed_sum, first_sum, elapsed_max;
+    double makespan = prefix_finish(service, arrival, finish, n, threads, &elapsed_sum, &first_sum, &elapsed_max);
+
+    Result *res = (Result*) malloc(sizeof(Result) * n);
+    for (int k = 0; k < n; ++k) {
+        const Process *p = &base[order[k]];
+        strcpy(res[k].name, p->name);
+        res[k].Elapsed = finish[k] - p->arrival;
+        res[k].CPU = cpu[k];
+        res[k].BLOCKED = io[k];
+        res[k].FirstRun = finish[k] - service[k] - p->arrival;
+    }
+    if (arrivals) {
+        multi_stats.cpus = 1;
+        multi_stats.makespan = makespan;
+        multi_stats.migrations = 0;
+        multi_stats.mean_slowdown = 1.0;
+    }
+    free(order);
+    free(service);
+    free(cpu);
+    free(io);
+    free(arrival);
+    free(finish);
+    *out_count = n;
+    return res;
+}
+
+/* ---- modo fast: SoA gerado em paralelo, sem Process nem Result ---- */
+
+typedef struct {
+    double *service, *arrival;
+    long lo, hi;
+    double mean, gap;       /* serviço médio; intervalo médio entre chegadas */
+    uint64_t seed;
+    double sum;             /* soma dos intervalos do bloco */
+    double offset;
+} GenChunk;
+
+static void * gen_chunk(void *arg) {
+    GenChunk *g = (GenChunk*) arg;
+    uint64_t state = g->seed ^ (0x9E3779B97F4A7C15ULL * (uint64_t) (g->lo + 1));
+    double t = 0.0;
+    for (long k = g->lo; k < g->hi; ++k) {
+        g->service[k] = rng_exp(&state, g->mean) + EPS;
+        if (g->arrival) {
+            t += rng_exp(&state, g->gap);
+            g->arrival[k] = t;
+        }
+    }
+    g->sum = t;
+    return NULL;
+}
+
+static void * gen_offset(void *arg) {
+    GenChunk *g = (GenChunk*) arg;
+    if (g->arrival) for (long k = g->lo; k < g->hi; ++k) g->arrival[k] += g->offset;
+    return NULL;
+}
+
+static void gen_threads(GenChunk *chunks, int threads, void *(*fn)(void*)) {
+    pthread_t *tids = (pthread_t*) malloc(sizeof(pthread_t) * threads);
+    for (int t = 1; t < threads; ++t) pthread_create(&tids[t], NULL, fn, &chunks[t]);
+    fn(&chunks[0]);
+    for (int t = 1; t < threads; ++t) pthread_join(tids[t], NULL);
+    free(tids);
+}
+
+/* Ordenação paralela de doubles positivos: radix LSD de 11 bits por bloco
+ * (o padrão de bits de um double positivo ordena como inteiro) e depois
+ * fusões dois a dois em paralelo */
+typedef struct {
+    double *src, *dst;
+    long lo, mid, hi;
+} SortChunk;
+
+static void * radix_chunk(void *arg) {
+    SortChunk *s = (SortChunk*) arg;
+    long n = s->hi - s->lo;
+    uint64_t *a = (uint64_t*) (s->src + s->lo), *b = (uint64_t*) (s->dst + s->lo);
+    long count[2048];
+    for (int shift = 0; shift < 64; shift += 11) {
+        memset(count, 0, sizeof(count));
+        for (long i = 0; i < n; ++i) count[(a[i] >> shift) & 0x7FF]++;
+        long sum = 0;
+        for (int d = 0; d < 2048; ++d) {
+            long c = count[d];
+            count[d] = sum;
+            sum += c;
+        }
+        for (long i = 0; i < n; ++i) b[count[(a[i] >> shift) & 0x7FF]++] = a[i];
+        uint64_t *swap = a;
+        a = b;
+        b = swap;
+    }
+    return NULL;   /* 6 passagens: o resultado volta a src */
+}
+
+static void * merge_chunk(void *arg) {
+    SortChunk *s = (SortChunk*) arg;
+    long i = s->lo, j = s->mid, k = s->lo;
+    while (i < s->mid && j < s->hi) s->dst[k++] = s->src[j] < s->src[i] ? s->src[j++] : s->src[i++];
+    while (i < s->mid) s->dst[k++] = s->src[i++];
+    while (j < s->hi) s->dst[k++] = s->src[j++];
+    return NULL;
+}
+
+static void sort_threads(SortChunk *chunks, int count, void *(*fn)(void*)) {
+    pthread_t *tids = (pthread_t*) malloc(sizeof(pthread_t) * count);
+    for (int t = 1; t < count; ++t) pthread_create(&tids[t], NULL, fn, &chunks[t]);
+    fn(&chunks[0]);
+    for (int t = 1; t < count; ++t) pthread_join(tids[t], NULL);
+    free(tids);
+}
+
+/* Ordena v[0..n) com T threads; tmp tem n entradas. Devolve o array com o resultado */
+static double * parallel_sort(double *v, double *tmp, long n, int threads) {
+    threads = scan_threads(n, threads);
+    SortChunk *chunks = (SortChunk*) malloc(sizeof(SortChunk) * threads);
+    for (int t = 0; t < threads; ++t) chunks[t] = (SortChunk) { v, tmp, n * t / threads, 0, n * (t + 1) / threads };
+    sort_threads(chunks, threads, radix_chunk);
+    long *bounds = (long*) malloc(sizeof(long) * (threads + 1));
+    for (int t = 0; t <= threads; ++t) bounds[t] = n * t / threads;
+    double *src = v, *dst = tmp;
+    for (int runs = threads; runs > 1; runs = (runs + 1) / 2) {
+        int pairs = 0;
+        for (int r = 0; r < runs; r += 2) {
+            long lo = bounds[r], mid = bounds[r + 1 < runs ? r + 1 : runs], hi = bounds[r + 2 < runs ? r + 2 : runs];
+            chunks[pairs++] = (SortChunk) { src, dst, lo, mid, hi };
+        }
+        sort_threads(chunks, pairs, merge_chunk);
+        for (int r = 0; r <= (runs + 1) / 2; ++r) bounds[r] = bounds[2 * r < runs ? 2 * r : runs];
+        double *swap = src;
+        src = dst;
+        dst = swap;
+    }
+    free(bounds);
+    free(chunks);
+    return src;
+}
+
+/* Compara run_closed_form com a simulação passo a passo (run_fifo/run_sjf,
+ * ou run_multi com chegadas) nos primeiros n jobs; devolve a maior diferença */
+static double closed_form_check(const char *alg, const double *service, const double *arrival, int n, int threads) {
+    Process *ps = (Process*) calloc(n, sizeof(Process));
+    for (int i = 0; i < n; ++i) {
+        snprintf(ps[i].name, sizeof(ps[i].name), "J%d", i);
+        ps[i].total_cpu_needed = service[i];
+        ps[i].arrival = arrival ? arrival[i] : 0.0;
+        ps[i].fanout = 1;
+    }
+    int n1, n2;
+    Result *fast = run_closed_form(alg, ps, n, threads, &n1);
+    Result *slow = arrival ? run_multi(alg, ps, n, &n2)
+                 : strcmp(alg, "sjf") == 0 ? run_sjf(ps, n, &n2) : run_fifo(ps, n, &n2);
+    double diff = n1 == n2 ? 0.0 : INFINITY;
+    for (int i = 0; i < n1 && i < n2; ++i) {
+        if (strcmp(fast[i].name, slow[i].name) != 0) diff = INFINITY;
+        double d = fabs(fast[i].Elapsed - slow[i].Elapsed) + fabs(fast[i].FirstRun - slow[i].FirstRun);
+        if (d > diff) diff = d;
+    }
+    free(fast);
+    free(slow);
+    free(ps);
+    return diff;
+}
+
+/* fifo/sjf sobre n jobs gerados (serviço exponencial de média mean, com
+ * chegadas de Poisson à carga load se load > 0; sjf só sem chegadas) */
+static int run_fast(const char *alg, long n, double load, double mean, uint64_t seed, int threads, int check) {
+    int sjf = strcmp(alg, "sjf") == 0;
+    double *service = (double*) malloc(sizeof(double) * n);
+    double *arrival = load > 0.0 ? (double*) malloc(sizeof(double) * n) : NULL;
+    double *tmp = sjf ? (double*) malloc(sizeof(double) * n) : NULL;
+    if (!service || (load > 0.0 && !arrival) || (sjf && !tmp)) {
+        fprintf(stderr, "Sem memória para %ld jobs\n", n);
+        return 1;
+    }
+
+    /* geração: blocos independentes; as chegadas são uma soma de prefixos */
+    double t0 = real_now();
+    int gt = scan_threads(n, threads);
+    GenChunk *gen = (GenChunk*) calloc(gt, sizeof(GenChunk));
+    for (int t = 0; t < gt; ++t) {
+        gen[t] = (GenChunk) { service, arrival, n * t / gt, n * (t + 1) / gt, mean, load > 0.0 ? mean / load : 0.0,
+                              seed, 0.0, 0.0 };
+    }
+    gen_threads(gen, gt, gen_chunk);
+    for (int t = 1; t < gt; ++t) gen[t].offset = gen[t - 1].offset + gen[t - 1].sum;
+    gen_threads(gen, gt, gen_offset);
+    free(gen);
+    double t_gen = real_now() - t0;
+
+    double diff = 0.0;
+    int checked = n < 100000 ? (int) n : 100000;
+    if (check) diff = closed_form_check(alg, service, arrival, checked, threads);
+
+    t0 = real_now();
+    const double *order = service;
+    if (sjf) order = parallel_sort(service, tmp, n, threads);
+    double t_sort = real_now() - t0;
+    double elapsed_sum, first_sum, elapsed_max;
+    double makespan = prefix_finish(order, arrival, NULL, n, threads, &elapsed_sum, &first_sum, &elapsed_max);
+    double t_eval = real_now() - t0;
+
+    printf("\n=== Forma fechada (algoritmo: %s, jobs: %ld, %s, threads: %d) ===\n", alg, n,
+           arrival ? "chegadas de Poisson" : "todos a 0", scan_threads(n, threads));
+    printf("Elapsed médio: %.3f, máximo: %.3f, FirstRun médio: %.3f, makespan: %.3f\n",
+           elapsed_sum / n, elapsed_max, first_sum / n, makespan);
+    printf("geração: %.3f s, avaliação: %.3f s", t_gen, t_eval);
+    if (sjf) printf(" (ordenação %.3f s)", t_sort);
+    printf(", %.0f jobs/s\n", n / t_eval);
+    if (check) printf("verificação contra a simulação passo a passo (%d jobs): diferença máxima %.3g\n", checked, diff);
+    free(service);
+    free(arrival);
+    free(tmp);
+    return check && diff > 1e-6 ? 1 : 0;
+}
+
+/* ------------------- Limites de referência (offline) ------------------- */
+
+/* Sobre os serviços solo (CPU + IO, que segura o CPU) e as chegadas, sem
+ * custo de troca nem interferência, que só somam tempo:
+ *  - SRPT preemptivo é ótimo para o Elapsed médio num CPU; com K CPUs um
+ *    CPU K vezes mais rápido dá um limite inferior;
+ *  - o makespan com K CPUs não desce de max(chegada_k + trabalho que chega
+ *    a partir dela / K) nem de max(chegada + serviço);
+ *  - processor sharing ideal (cada um dos m ativos corre a min(1, K/m))
+ *    não é um limite, é a referência de partilha justa.
+ * Tudo com um heap em O(n log n); arrival vem ordenado. */
+
+typedef struct {
+    double key;      /* SRPT: trabalho restante; PS: tempo virtual de fim */
+    double arrival;
+} BoundItem;
+
+typedef struct {
+    BoundItem *items;
+    long size;
+} BoundHeap;
+
+static void bound_push(BoundHeap *h, double key, double arrival) {
+    long i = h->size++;
+    while (i > 0 && h->items[(i - 1) / 2].key > key) {
+        h->items[i] = h->items[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    h->items[i] = (BoundItem) { key, arrival };
+}
+
+static void bound_pop(BoundHeap *h) {
+    BoundItem last = h->items[--h->size];
+    long i = 0;
+    for (;;) {
+        long c = 2 * i + 1;
+        if (c >= h->size) break;
+        if (c + 1 < h->size && h->items[c + 1].key < h->items[c].key) c++;
+        if (last.key <= h->items[c].key) break;
+        h->items[i] = h->items[c];
+        i = c;
+    }
+    if (h->size > 0) h->items[i] = last;
+}
+
+/* Elapsed médio de SRPT num CPU com velocidade speed */
+static double srpt_mean_flow(const double *service, const double *arrival, long n, double speed) {
+    BoundHeap h = { (BoundItem*) malloc(sizeof(BoundItem) * n), 0 };
+    double t = 0.0, sum = 0.0;
+    long i = 0;
+    while (i < n || h.size > 0) {
+        if (h.size == 0 && t < arrival[i]) t = arrival[i];
+        while (i < n && arrival[i] <= t) { bound_push(&h, service[i], arrival[i]); i++; }
+        double next = i < n ? arrival[i] : INFINITY;
+        double done = t + h.items[0].key / speed;
+        if (done <= next) {
+            t = done;
+            sum += t - h.items[0].arrival;
+            bound_pop(&h);
+        } else {
+            h.items[0].key -= (next - t) * speed;  /* o topo só diminui: continua o mínimo */
+            t = next;
+        }
+    }
+    free(h.items);
+    return n ? sum / n : 0.0;
+}
+
+/* Elapsed médio de processor sharing ideal com k CPUs: o tempo virtual V
+ * avança à taxa de cada ativo e um job acaba quando V chega a V(chegada) + serviço */
+static double ps_mean_flow(const double *service, const double *arrival, long n, int k) {
+    BoundHeap h = { (BoundItem*) malloc(sizeof(BoundItem) * n), 0 };
+    double t = 0.0, v = 0.0, sum = 0.0;
+    long i = 0;
+    while (i < n || h.size > 0) {
+        if (h.size == 0 && t < arrival[i]) t = arrival[i];
+        while (i < n && arrival[i] <= t) { bound_push(&h, v + service[i], arrival[i]); i++; }
+        double rate = h.size <= k ? 1.0 : (double) k / h.size;
+        double next = i < n ? arrival[i] : INFINITY;
+        double done = t + (h.items[0].key - v) / rate;
+        if (done <= next) {
+            t = done;
+            v = h.items[0].key;
+            sum += t - h.items[0].arrival;
+            bound_pop(&h);
+        } else {
+            v += (next - t) * rate;
+            t = next;
+        }
+    }
+    free(h.items);
+    return n ? sum / n : 0.0;
+}
+
+static double makespan_bound(const double *service, const double *arrival, long n, int k) {
+    double bound = 0.0, suffix = 0.0;
+    for (long i = n - 1; i >= 0; --i) {
+        suffix += service[i];
+        if (arrival[i] + suffix / k > bound) bound = arrival[i] + suffix / k;
+        if (arrival[i] + service[i] > bound) bound = arrival[i] + service[i];
+    }
+    return bound;
+}
+
+static int cmp_index_name(const void *a, const void *b, void *arg) {
+    const Process *ps = (const Process*) arg;
+    return strcmp(ps[*(const int*) a].name, ps[*(const int*) b].name);
+}
+
+static void print_gap(const char *label, double policy, double ref) {
+    double gap = ref > 0.0 && fabs(policy - ref) > 1e-9 * ref ? 100.0 * (policy - ref) / ref : 0.0;
+    printf(" | %s %.3f (%+.1f%%)", label, ref, gap);
+}
+
+/* Imprime os limites ao lado do resultado avg (médias por processo) da política */
+static void print_bounds(Process *base, int n, int k, Result *avg, int proc_count) {
+    int *order = (int*) malloc(sizeof(int) * n);
+    for (int i = 0; i < n; ++i) order[i] = i;
+    qsort_r(order, n, sizeof(int), cmp_index_arrival, base);
+    double *service = (double*) malloc(sizeof(double) * n);
+    double *arrival = (double*) malloc(sizeof(double) * n);
+    for (int j = 0; j < n; ++j) {
+        double cpu, io;
+        service[j] = solo_service(&base[order[j]], &cpu, &io);
+        arrival[j] = base[order[j]].arrival;
+    }
+    double work = 0.0;
+    for (int j = 0; j < n; ++j) work += service[j];
+    double srpt = srpt_mean_flow(service, arrival, n, k);
+    if (k > 1 && srpt < work / n) srpt = work / n;   /* cada um demora pelo menos o seu serviço */
+    double ps = ps_mean_flow(service, arrival, n, k);
+    double span = makespan_bound(service, arrival, n, k);
+
+    /* makespan da política: fim = chegada + Elapsed, com o processo encontrado pelo nome */
+    qsort_r(order, n, sizeof(int), cmp_index_name, base);
+    double elapsed = 0.0, policy_span = 0.0;
+    for (int i = 0; i < proc_count; ++i) {
+        elapsed += avg[i].Elapsed;
+        int lo = 0, hi = n - 1;
+        while (lo < hi) {
+            int mid = (lo + hi) / 2;
+            if (strcmp(base[order[mid]].name, avg[i].name) < 0) lo = mid + 1;
+            else hi = mid;
+        }
+        double arr = n && strcmp(base[order[lo]].name, avg[i].name) == 0 ? base[order[lo]].arrival : 0.0;
+        if (arr + avg[i].Elapsed > policy_span) policy_span = arr + avg[i].Elapsed;
+    }
+    if (proc_count > 0) elapsed /= proc_count;
+
+    printf("Referência offline (%d CPU%s, sem trocas):\n", k, k > 1 ? "s" : "");
+    printf("  Elapsed médio: %.3f", elapsed);
+    char label[48];
+    if (k > 1) snprintf(label, sizeof(label), "SRPT num CPU %dx mais rápido", k);
+    else snprintf(label, sizeof(label), "SRPT ótimo");
+    print_gap(label, elapsed, srpt);
+    print_gap("PS ideal", elapsed, ps);
+    printf("\n  makespan: %.3f", policy_span);
+    print_gap("limite inferior", policy_span, span);
+    printf("\n");
+    free(order);
+    free(service);
+    free(arrival);
+}
+
+/* ------------------- Estado estacionário: MSER-5 e batch means ------------------- */
+
+/* Numa só corrida longa o início (sistema vazio) enviesa as médias. O
+ * motor entrega cada observação por ordem de conclusão e só se guardam
+ * médias de lotes de MSER_BATCH. No fim o aquecimento d (em lotes, até
+ * metade) minimiza MSER(d) = soma((z - média)²) / (m - d)² sobre os lotes
+ * d..m-1, e o resto é agrupado em BM_BATCHES lotes para um intervalo de
+ * confiança t de 95 %. */
+
+#define MSER_BATCH 5
+#define BM_BATCHES 30
+
+typedef struct {
+    double *means;    /* médias dos lotes de MSER_BATCH completos */
+    long count, cap;
+    double partial;   /* soma do lote em curso */
+    int in_partial;
+} SteadyState;
+
+typedef struct {
+    long observations, warmup;  /* warmup em observações */
+    double raw_mean, mean, half;
+    int batches;
+    long batch_size;            /* observações por lote do IC */
+} SteadyEstimate;
+
+static void steady_add(SteadyState *s, double x) {
+    s->partial += x;
+    if (++s->in_partial < MSER_BATCH) return;
+    if (s->count == s->cap) {
+        s->cap = s->cap ? 2 * s->cap : 1024;
+        s->means = (double*) realloc(s->means, sizeof(double) * s->cap);
+    }
+    s->means[s->count++] = s->partial / MSER_BATCH;
+    s->partial = 0.0;
+    s->in_partial = 0;
+}
+
+/* quantil 0.975 da t de Student com v graus de liberdade (Cornish-Fisher) */
+static double t_quantile(int v) {
+    const double z = 1.959964;
+    double z3 = z * z * z, z5 = z3 * z * z;
+    return z + (z3 + z) / (4.0 * v) + (5.0 * z5 + 16.0 * z3 + 3.0 * z) / (96.0 * v * v);
+}
+
+static SteadyEstimate steady_estimate(const SteadyState *s) {
+    SteadyEstimate e = { s->count * MSER_BATCH, 0, 0.0, 0.0, INFINITY, 0, 0 };
+    long m = s->count;
+    if (m == 0) return e;
+    double sum = 0.0, sq = 0.0, best = INFINITY;
+    long d_best = 0;
+    for (long d = m - 1; d >= 0; --d) {
+        sum += s->means[d];
+        sq += s->means[d] * s->means[d];
+        long k = m - d;
+        double mser = (sq - sum * sum / k) / ((double) k * k);
+        if (d <= m / 2 && mser <= best) {
+            best = mser;
+            d_best = d;
+        }
+    }
+    e.raw_mean = sum / m;
+    e.warmup = d_best * MSER_BATCH;
+
+    /* batch means sobre o que sobra; o resto da divisão sai do início */
+    long left = m - d_best;
+    int b = left >= BM_BATCHES ? BM_BATCHES : (int) left;
+    long size = left / b;
+    long first = m - (long) b * size;
+    double total = 0.0, total_sq = 0.0;
+    for (int j = 0; j < b; ++j) {
+        double bsum = 0.0;
+        for (long i = 0; i < size; ++i) bsum += s->means[first + j * size + i];
+        bsum /= size;
+        total += bsum;
+        total_sq += bsum * bsum;
+    }
+    e.mean = total / b;
+    e.batches = b;
+    e.batch_size = size * MSER_BATCH;
+    if (b > 1) {
+        double var = (total_sq - total * total / b) / (b - 1);
+        e.half = t_quantile(b - 1) * sqrt(var > 0.0 ? var / b : 0.0);
+    }
+    return e;
+}
+
+static void print_steady(const char *label, const SteadyState *s) {
+    SteadyEstimate e = steady_estimate(s);
+    if (e.observations == 0) return;
+    printf("regime estacionário (%s): aquecimento MSER-%d de %ld (%.1f %%), média %.4f ± %.4f "
+           "(IC 95 %%, %d lotes de %ld); sem truncar %.4f\n", label, MSER_BATCH, e.warmup,
+           100.0 * e.warmup / e.observations, e.mean, e.half, e.batches, e.batch_size, e.raw_mean);
+}
+
+/* ------------------- Cluster: dispatcher global e muitos hosts ------------------- */
+
+typedef enum { DISPATCH_RANDOM, DISPATCH_RR, DISPATCH_JSQ, DISPATCH_PO2, DISPATCH_LEAST, N_DISPATCH } DispatchPolicy;
+static const char *dispatch_names[N_DISPATCH] = { "random", "rr", "jsq", "po2", "least" };
+
+/* O que o controlador de autoscaling vê em cada período */
+typedef struct {
+    double util;    /* fração do período em que os hosts ativos tiveram CPU ocupado */
+    double queue;   /* jobs no sistema por host ativo */
+    int active;     /* hosts a aceitar trabalho */
+    int booting;
+} ScaleObs;
+
+/* Controlador: devolve o número de hosts desejado (ativos + a arrancar) */
+typedef struct {
+    const char *name;
+    double default_target;
+    int (*desired)(const ScaleObs *o, double target);
+} ScaleController;
+
+/* Segue um alvo de utilização: hosts tais que util ficaria em target */
+static int scale_util(const ScaleObs *o, double target) {
+    return (int) ceil(o->active * o->util / target);
+}
+
+/* Segue um alvo de jobs por host */
+static int scale_queue(const ScaleObs *o, double target) {
+    return (int) ceil(o->active * o->queue / target);
+}
+
+static const ScaleController scale_controllers[] = {
+    { "util", 0.7, scale_util },
+    { "queue", 2.0, scale_queue },
+};
+#define N_CONTROLLERS ((int) (sizeof(scale_controllers) / sizeof(scale_controllers[0])))
+
+typedef struct {
+    int hosts;          /* com autoscaling: máximo */
+    DispatchPolicy policy;
+    uint64_t seed;
+    double hedge;       /* < 0: sem hedging */
+    /* autoscaling (ctl NULL: os hosts estão sempre todos ativos) */
+    const ScaleController *ctl;
+    double target;
+    int min_hosts;
+    double period;      /* intervalo entre decisões */
+    double delay;       /* arranque de um host novo */
+    double cooldown;    /* sem decisões depois de escalar */
+    double slo;         /* latência alvo por pedido, <= 0: não reporta */
+} ClusterConfig;
+
+typedef struct {
+    double req_mean, req_p99;
+    double slo_met;     /* fração dos pedidos dentro do SLO */
+    double host_time;   /* integral dos hosts ligados (a arrancar, ativos ou a escoar) */
+    double makespan;
+    int peak_hosts, scale_ups, scale_downs;
+} ClusterSummary;
+
+enum { HOST_OFF, HOST_BOOT, HOST_ON, HOST_DRAIN };
+
+/* Estado compacto por host: um CPU com a política local */
+typedef struct {
+    RunQueue rq;
+    Process *running;   /* NULL: ocioso */
+    Process *last;
+    double slice_used;  /* CPU de trabalho do slice em curso */
+    double slice_end;   /* eventos com outro t no heap estão obsoletos */
+    int jobs;           /* na fila + a correr */
+    double work;        /* CPU ainda por fazer dos jobs atribuídos */
+    double busy;
+    int state;
+} Host;
+
+/* Fim do slice em curso de um host (um válido por host; cancelar uma
+ * cópia a correr deixa o antigo no heap, ignorado ao sair) */
+typedef struct {
+    double t;
+    int host;
+} HostEvent;
+
+typedef struct {
+    const ClusterConfig *cfg;
+    int preemptive, sjf, mlfq;
+    Host *hosts;
+    HostEvent *heap;
+    int heap_len, heap_cap;
+    /* árvore de mínimos sobre os hosts (jsq: jobs, least: work) */
+    double *key;
+    int *tree;
+    int tree_size;
+    uint64_t rng;
+    unsigned rr_next;
+    long events;
+    /* hosts ativos, para escolher ao acaso/rr só entre eles */
+    int *active, *active_pos;
+    int n_active;
+    /* arranques pendentes: todos demoram delay, por isso saem por ordem */
+    int *boot;
+    double *boot_ready;
+    int boot_head, boot_tail;
+    /* custo: integral do número de hosts ligados */
+    int powered, peak;
+    double host_time, t_powered;
+    int ups, downs;
+    /* folhas (e cópias de hedging), indexadas por Process.id */
+    int *host_of;
+    int *twin;                /* cópia da mesma folha, -1 se não há */
+    unsigned char *cancelled; /* a outra cópia terminou primeiro */
+    SteadyState steady;       /* Elapsed por folha, por ordem de conclusão */
+} Cluster;
+
+static void heap_push_event(Cluster *cl, double t, int host) {
+    if (cl->heap_len == cl->heap_cap) {
+        cl->heap_cap *= 2;
+        cl->heap = (HostEvent*) realloc(cl->heap, sizeof(HostEvent) * cl->heap_cap);
+    }
+    int i = cl->heap_len++;
+    while (i > 0 && cl->heap[(i - 1) / 2].t > t) {
+        cl->heap[i] = cl->heap[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    cl->heap[i] = (HostEvent) { t, host };
+}
+
+static HostEvent heap_pop_event(Cluster *cl) {
+    HostEvent top = cl->heap[0];
+    HostEvent last = cl->heap[--cl->heap_len];
+    int i = 0;
+    for (;;) {
+        int c = 2 * i + 1;
+        if (c >= cl->heap_len) break;
+        if (c + 1 < cl->heap_len && cl->heap[c + 1].t < cl->heap[c].t) c++;
+        if (cl->heap[c].t >= last.t) break;
+        cl->heap[i] = cl->heap[c];
+        i = c;
+    }
+    if (cl->heap_len > 0) cl->heap[i] = last;
+    return top;
+}
+
+static int tree_better(const Cluster *cl, int a, int b) {
+    if (cl->key[a] != cl->key[b]) return cl->key[a] < cl->key[b];
+    return a < b;
+}
+
+/* Hosts que não estão ativos ficam com +inf e nunca são escolhidos */
+static void tree_update(Cluster *cl, int host) {
+    if (cl->cfg->policy != DISPATCH_JSQ && cl->cfg->policy != DISPATCH_LEAST) return;
+    const Host *h = &cl->hosts[host];
+    if (h->state != HOST_ON) cl->key[host] = INFINITY;
+    else cl->key[host] = cl->cfg->policy == DISPATCH_JSQ ? h->jobs : h->work;
+    for (int node = (host + cl->tree_size) / 2; node >= 1; node /= 2) {
+        int a = cl->tree[2 * node], b = cl->tree[2 * node + 1];
+        cl->tree[node] = tree_better(cl, a, b) ? a : b;
+    }
+}
+
+static int cluster_choose(Cluster *cl) {
+    switch (cl->cfg->policy) {
+    case DISPATCH_RANDOM:
+        return cl->active[rng_next(&cl->rng) % (uint64_t) cl->n_active];
+    case DISPATCH_RR:
+        return cl->active[cl->rr_next++ % (unsigned) cl->n_active];
+    case DISPATCH_PO2: {
+        int a = cl->active[rng_next(&cl->rng) % (uint64_t) cl->n_active];
+        int b = cl->active[rng_next(&cl->rng) % (uint64_t) cl->n_active];
+        return cl->hosts[b].jobs < cl->hosts[a].jobs ? b : a;
+    }
+    default:
+        return cl->tree[1];
+    }
+}
+
+static void cluster_powered(Cluster *cl, double now, int delta) {
+    cl->host_time += cl->powered * (now - cl->t_powered);
+    cl->t_powered = now;
+    cl->powered += delta;
+    if (cl->powered > cl->peak) cl->peak = cl->powered;
+}
+
+static void host_activate(Cluster *cl, int i) {
+    cl->hosts[i].state = HOST_ON;
+    cl->active_pos[i] = cl->n_active;
+    cl->active[cl->n_active++] = i;
+    tree_update(cl, i);
+}
+
+/* Deixa de receber trabalho; desliga quando a fila esvaziar */
+static void host_drain(Cluster *cl, int i, double now) {
+    int pos = cl->active_pos[i], moved = cl->active[--cl->n_active];
+    cl->active[pos] = moved;
+    cl->active_pos[moved] = pos;
+    Host *h = &cl->hosts[i];
+    h->state = HOST_DRAIN;
+    if (!h->running) {
+        h->state = HOST_OFF;
+        cluster_powered(cl, now, -1);
+    }
+    tree_update(cl, i);
+}
+
+static void host_start(Cluster *cl, int i, double now) {
+    Host *h = &cl->hosts[i];
+    Process *p;
+    do {
+        p = runq_pop(&h->rq, cl->sjf);
+    } while (p && cl->cancelled && cl->cancelled[p->id]);
+    h->running = p;
+    if (!p) {
+        if (h->state == HOST_DRAIN) {
+            h->state = HOST_OFF;
+            cluster_powered(cl, now, -1);
+        }
+        return;
+    }
+    double t = now;
+    dispatch(p, &h->last, &t);
+    h->slice_used = slice_run(p, cl->preemptive, 1.0, &t);
+    h->busy += t - now;
+    h->slice_end = t;
+    heap_push_event(cl, t, i);
+}
+
+/* A outra cópia da folha terminou em now: se p está na fila é descartada
+ * quando sair dela; se está a correr perde o CPU já e devolve o resto do slice */
+static void cluster_cancel(Cluster *cl, Process *p, double now) {
+    int i = cl->host_of[p->id];
+    Host *h = &cl->hosts[i];
+    cl->cancelled[p->id] = 1;
+    h->jobs--;
+    h->work -= p->remaining;
+    if (h->running == p) {
+        double refund = h->slice_end - now;
+        h->busy -= refund;
+        h->work -= h->slice_used;
+        p->cpu_consumed -= refund < h->slice_used ? refund : h->slice_used;
+        host_start(cl, i, now);
+    }
+    tree_update(cl, i);
+}
+
+static void host_complete(Cluster *cl, int i, double now, Process *leaves) {
+    Host *h = &cl->hosts[i];
+    Process *p = h->running;
+    if (is_done(p)) {
+        p->finish_time = now;
+        h->work -= h->slice_used;
+        h->jobs--;
+        int other = cl->twin ? cl->twin[p->id] : -1;
+        double arrival = other >= 0 && leaves[other].arrival < p->arrival ? leaves[other].arrival : p->arrival;
+        steady_add(&cl->steady, now - arrival);
+        if (other >= 0 && leaves[other].finish_time < 0.0) cluster_cancel(cl, &leaves[other], now);
+    } else {
+        h->work -= h->slice_used;
+        if (cl->mlfq) p->level = mlfq_next_level(p->level, h->slice_used > QUANTUM - 1e-9, MLFQ_LEVELS);
+        runq_push(&h->rq, cl->sjf, p);
+    }
+    host_start(cl, i, now);
+    tree_update(cl, i);
+}
+
+/* Entrega p a um host escolhido pelo dispatcher, evitando avoid se possível */
+static void cluster_arrival(Cluster *cl, Process *p, int avoid) {
+    int i = cluster_choose(cl);
+    if (i == avoid && cl->n_active > 1) i = cl->active[(cl->active_pos[i] + 1) % cl->n_active];
+    Host *h = &cl->hosts[i];
+    cl->host_of[p->id] = i;
+    runq_push(&h->rq, cl->sjf, p);
+    h->jobs++;
+    h->work += p->remaining;
+    if (!h->running) host_start(cl, i, p->arrival);
+    tree_update(cl, i);
+}
+
+/* Uma decisão do controlador. Subir reaproveita primeiro hosts a escoar
+ * (sem atraso) e depois liga hosts desligados, que só ficam ativos ao fim
+ * de delay; descer escoa os hosts ativos com menos jobs. */
+static void cluster_scale(Cluster *cl, double now, double busy_delta, double *cooldown_until) {
+    const ClusterConfig *cfg = cl->cfg;
+    int booting = cl->boot_tail - cl->boot_head;
+    if (now < *cooldown_until) return;
+    ScaleObs o = { 0.0, 0.0, cl->n_active, booting };
+    long jobs = 0;
+    for (int k = 0; k < cl->n_active; ++k) jobs += cl->hosts[cl->active[k]].jobs;
+    o.util = busy_delta / (cl->n_active * cfg->period);
+    o.queue = (double) jobs / cl->n_active;
+
+    int want = cfg->ctl->desired(&o, cfg->target);
+    if (want < cfg->min_hosts) want = cfg->min_hosts;
+    if (want > cfg->hosts) want = cfg->hosts;
+    int have = cl->n_active + booting;
+    if (want > have) {
+        for (int i = 0; i < cfg->hosts && have < want; ++i) {
+            if (cl->hosts[i].state == HOST_DRAIN) { host_activate(cl, i); have++; }
+        }
+        for (int i = 0; i < cfg->hosts && have < want; ++i) {
+            if (cl->hosts[i].state != HOST_OFF) continue;
+            cl->hosts[i].state = HOST_BOOT;
+            cl->boot[cl->boot_tail % cfg->hosts] = i;
+            cl->boot_ready[cl->boot_tail % cfg->hosts] = now + cfg->delay;
+            cl->boot_tail++;
+            cluster_powered(cl, now, +1);
+            have++;
+        }
+        cl->ups++;
+        *cooldown_until = now + cfg->cooldown;
+    } else if (want < have && cl->n_active > 1) {
+        for (int drop = have - want; drop > 0 && cl->n_active > 1; --drop) {
+            int best = cl->active[0];
+            for (int k = 1; k < cl->n_active; ++k) {
+                if (cl->hosts[cl->active[k]].jobs < cl->hosts[best].jobs) best = cl->active[k];
+            }
+            host_drain(cl, best, now);
+        }
+        cl->downs++;
+        *cooldown_until = now + cfg->cooldown;
+    }
+}
+
+static void print_latency_header(void) {
+    printf("%-9s | %10s | %9s | %9s | %9s | %9s | %9s\n", "", "média", "p50", "p90", "p99", "p99.9", "max");
+    printf("-------------------------------------------------------------------------\n");
+}
+
+/* Ordena v e imprime média e percentis */
+static void print_latency_row(const char *label, double *v, int n) {
+    if (n == 0) return;
+    double sum = 0.0;
+    for (int i = 0; i < n; ++i) sum += v[i];
+    qsort(v, n, sizeof(double), cmp_double);
+    printf("%-9s | %9.3f | %9.3f | %9.3f | %9.3f | %9.3f | %9.3f\n", label, sum / n,
+           v[(int) (0.50 * (n - 1))], v[(int) (0.90 * (n - 1))], v[(int) (0.99 * (n - 1))],
+           v[(int) (0.999 * (n - 1))], v[n - 1]);
+}
+
+/* Simula os pedidos em cfg->hosts hosts de um CPU com a política local alg,
+ * atrás de um dispatcher. Cada pedido abre fanout folhas iguais em hosts
+ * escolhidos um a um e termina com a folha mais lenta. Com hedging, uma
+ * folha ainda por terminar cfg->hedge depois de chegar ganha uma cópia
+ * noutro host; conta a primeira a terminar e a outra é cancelada. Com
+ * autoscaling o controlador decide de cfg->period em cfg->period quantos
+ * hosts quer, a começar em cfg->min_hosts.
+ * Eventos: chegadas, hedges e arranques (todos já por ordem), decisões
+ * periódicas e um fim de slice por host ocupado num heap, por isso cada
+ * evento custa O(log H); jsq/least escolhem o host numa árvore de mínimos.
+ * Preenche sum; com verbose imprime também o relatório. */
+static void simulate_cluster(const char *alg, const char *label, const Process *reqs, int n,
+                             const ClusterConfig *cfg, int verbose, ClusterSummary *sum) {
+    Cluster cl;
+    memset(&cl, 0, sizeof(cl));
+    cl.cfg = cfg;
+    cl.preemptive = strcmp(alg, "rr") == 0 || strcmp(alg, "mlfq") == 0;
+    cl.sjf = strcmp(alg, "sjf") == 0;
+    cl.mlfq = strcmp(alg, "mlfq") == 0;
+    cl.rng = cfg->seed;
+    cl.hosts = (Host*) calloc(cfg->hosts, sizeof(Host));
+    cl.heap_cap = cfg->hosts;
+    cl.heap = (HostEvent*) malloc(sizeof(HostEvent) * cl.heap_cap);
+    cl.tree_size = 1;
+    while (cl.tree_size < cfg->hosts) cl.tree_size *= 2;
+    cl.key = (double*) malloc(sizeof(double) * cl.tree_size);
+    cl.tree = (int*) malloc(sizeof(int) * 2 * cl.tree_size);
+    for (int i = 0; i < cl.tree_size; ++i) {
+        cl.key[i] = INFINITY;
+        cl.tree[cl.tree_size + i] = i;
+    }
+    for (int node = cl.tree_size - 1; node >= 1; --node) cl.tree[node] = cl.tree[2 * node];
+    cl.active = (int*) malloc(sizeof(int) * cfg->hosts);
+    cl.active_pos = (int*) malloc(sizeof(int) * cfg->hosts);
+    cl.boot = (int*) malloc(sizeof(int) * cfg->hosts);
+    cl.boot_ready = (double*) malloc(sizeof(double) * cfg->hosts);
+    int start = cfg->ctl ? cfg->min_hosts : cfg->hosts;
+    for (int i = 0; i < start; ++i) host_activate(&cl, i);
+    cluster_powered(&cl, 0.0, start);
+
+    /* folhas por ordem de chegada dos pedidos; as cópias vão para o fim */
+    const Process **order = (const Process**) malloc(sizeof(Process*) * n);
+    for (int i = 0; i < n; ++i) order[i] = &reqs[i];
+    qsort(order, n, sizeof(Process*), cmp_arrival);
+    int nleaves = 0, fanout_max = 1;
+    for (int i = 0; i < n; ++i) {
+        nleaves += reqs[i].fanout;
+        if (reqs[i].fanout > fanout_max) fanout_max = reqs[i].fanout;
+    }
+    int hedging = cfg->hedge >= 0.0;
+    int cap = hedging ? 2 * nleaves : nleaves;
+    Process *leaves = (Process*) malloc(sizeof(Process) * cap);
+    int *req_of = (int*) malloc(sizeof(int) * cap);
+    cl.host_of = (int*) malloc(sizeof(int) * cap);
+    if (hedging) {
+        cl.twin = (int*) malloc(sizeof(int) * cap);
+        cl.cancelled = (unsigned char*) calloc(cap, 1);
+    }
+    int nl = 0;
+    for (int i = 0; i < n; ++i) {
+        for (int k = 0; k < order[i]->fanout; ++k) {
+            leaves[nl] = *order[i];
+            reset_process(&leaves[nl], nl);
+            req_of[nl] = i;
+            if (hedging) cl.twin[nl] = -1;
+            nl++;
+        }
+    }
+
+    double t0 = real_now();
+    int next = 0, hnext = hedging ? 0 : nleaves;
+    double t_tick = cfg->ctl ? cfg->period : INFINITY, cooldown_until = 0.0, busy_prev = 0.0;
+    while (next < nleaves || hnext < nleaves || cl.heap_len > 0) {
+        double t_arr = next < nleaves ? leaves[next].arrival : INFINITY;
+        double t_hedge = hnext < nleaves ? leaves[hnext].arrival + cfg->hedge : INFINITY;
+        double t_slice = cl.heap_len > 0 ? cl.heap[0].t : INFINITY;
+        double t_boot = cl.boot_head < cl.boot_tail ? cl.boot_ready[cl.boot_head % cfg->hosts] : INFINITY;
+        if (t_slice <= t_arr && t_slice <= t_hedge && t_slice <= t_boot && t_slice <= t_tick) {
+            HostEvent ev = heap_pop_event(&cl);
+            Host *h = &cl.hosts[ev.host];
+            if (h->running && ev.t == h->slice_end) host_complete(&cl, ev.host, ev.t, leaves);
+        } else if (t_boot <= t_arr && t_boot <= t_hedge && t_boot <= t_tick) {
+            host_activate(&cl, cl.boot[cl.boot_head++ % cfg->hosts]);
+        } else if (t_arr <= t_hedge && t_arr <= t_tick) {
+            cluster_arrival(&cl, &leaves[next++], -1);
+        } else if (t_hedge <= t_tick) {
+            Process *orig = &leaves[hnext++];
+            if (orig->finish_time < 0.0) {
+                Process *copy = &leaves[nl];
+                *copy = *orig;
+                reset_process(copy, nl);
+                copy->arrival = t_hedge;
+                req_of[nl] = req_of[orig->id];
+                cl.twin[nl] = orig->id;
+                cl.twin[orig->id] = nl;
+                nl++;
+                cluster_arrival(&cl, copy, cl.host_of[orig->id]);
+            }
+        } else {
+            double busy = 0.0;
+            for (int i = 0; i < cfg->hosts; ++i) busy += cl.hosts[i].busy;
+            cluster_scale(&cl, t_tick, busy - busy_prev, &cooldown_until);
+            busy_prev = busy;
+            t_tick += cfg->period;
+        }
+        cl.events++;
+    }
+    double wall = real_now() - t0;
+
+    /* folha: a primeira cópia a terminar; pedido: a folha mais lenta */
+    double *elapsed = (double*) malloc(sizeof(double) * nleaves);
+    double *first = (double*) malloc(sizeof(double) * nleaves);
+    double *req_done = (double*) malloc(sizeof(double) * n);
+    double makespan = 0.0, busy = 0.0, work = 0.0, wasted = 0.0;
+    for (int i = 0; i < n; ++i) req_done[i] = 0.0;
+    for (int i = 0; i < nleaves; ++i) {
+        Process *p = &leaves[i];
+        double done = p->finish_time, started = p->first_run_time;
+        int other = hedging ? cl.twin[i] : -1;
+        if (other >= 0) {
+            Process *c = &leaves[other];
+            Process *loser = p;
+            if (c->finish_time >= 0.0 && (done < 0.0 || c->finish_time < done)) done = c->finish_time;
+            else loser = c;
+            if (c->first_run_time >= 0.0 && (started < 0.0 || c->first_run_time < started)) started = c->first_run_time;
+            wasted += loser->cpu_consumed + loser->stall_time;
+        }
+        elapsed[i] = done - p->arrival;
+        first[i] = started - p->arrival;
+        work += p->total_cpu_needed;
+        if (done > req_done[req_of[i]]) req_done[req_of[i]] = done;
+        if (done > makespan) makespan = done;
+    }
+    int met = 0;
+    double req_sum = 0.0;
+    for (int i = 0; i < n; ++i) {
+        req_done[i] -= order[i]->arrival;
+        req_sum += req_done[i];
+        if (req_done[i] <= cfg->slo) met++;
+    }
+    for (int i = 0; i < cfg->hosts; ++i) {
+        busy += cl.hosts[i].busy;
+        runq_free(&cl.hosts[i].rq);
+    }
+    cluster_powered(&cl, makespan, 0);
+
+    sum->req_mean = req_sum / n;
+    sum->slo_met = (double) met / n;
+    sum->host_time = cl.host_time;
+    sum->makespan = makespan;
+    sum->peak_hosts = cl.peak;
+    sum->scale_ups = cl.ups;
+    sum->scale_downs = cl.downs;
+    if (verbose) {
+        printf("\n=== Cluster (algoritmo: %s, cenário: %s, hosts: %d, dispatcher: %s, jobs: %d) ===\n",
+               alg, label, cfg->hosts, dispatch_names[cfg->policy], n);
+        print_latency_header();
+        print_latency_row("Elapsed", elapsed, nleaves);
+        print_latency_row("FirstRun", first, nleaves);
+        if (fanout_max > 1 || hedging) print_latency_row("Pedido", req_done, n);
+        printf("-------------------------------------------------------------------------\n");
+        if (fanout_max > 1) printf("folhas: %d (fan-out até %d; Elapsed/FirstRun por folha)\n", nleaves, fanout_max);
+        if (hedging) {
+            printf("hedging após %.3f: %d cópias (%.2f %% das folhas), CPU desperdiçado: %.3f (%.2f %% do trabalho)\n",
+                   cfg->hedge, nl - nleaves, 100.0 * (nl - nleaves) / nleaves, wasted,
+                   work > 0.0 ? 100.0 * wasted / work : 0.0);
+        }
+        if (cfg->ctl) {
+            printf("autoscaling %s (alvo %g, hosts %d..%d, período %g, arranque %g, cooldown %g): "
+                   "+%d / -%d decisões, pico %d hosts\n", cfg->ctl->name, cfg->target, cfg->min_hosts,
+                   cfg->hosts, cfg->period, cfg->delay, cfg->cooldown, cl.ups, cl.downs, cl.peak);
+            printf("custo: %.3f CPU-horas (%.1f hosts em média)\n", cl.host_time / 3600.0,
+                   makespan > 0.0 ? cl.host_time / makespan : 0.0);
+        }
+        if (cfg->slo > 0.0) printf("SLO %.3f: %.2f %% dos pedidos\n", cfg->slo, 100.0 * met / n);
+        print_steady("Elapsed por folha", &cl.steady);
+        printf("utilização: %.1f %%, makespan: %.3f, eventos: %ld em %.2f s (%.0f eventos/s)\n",
+               cl.host_time > 0.0 ? 100.0 * busy / cl.host_time : 0.0, makespan,
+               cl.events, wall, wall > 0.0 ? cl.events / wall : 0.0);
+    }
+    qsort(req_done, n, sizeof(double), cmp_double);
+    sum->req_p99 = req_done[(int) (0.99 * (n - 1))];
+
+    free(elapsed);
+    free(first);
+    free(req_done);
+    free(order);
+    free(leaves);
+    free(req_of);
+    free(cl.host_of);
+    free(cl.twin);
+    free(cl.cancelled);
+    free(cl.hosts);
+    free(cl.heap);
+    free(cl.key);
+    free(cl.tree);
+    free(cl.active);
+    free(cl.active_pos);
+    free(cl.boot);
+    free(cl.boot_ready);
+    free(cl.steady.means);
+}
+
+/* Varrimento de configurações de autoscaling sobre o mesmo traço; as
+ * simulações são independentes e partilham só os pedidos (só leitura) */
+typedef struct {
+    const char *alg;
+    const Process *reqs;
+    int n;
+    const ClusterConfig *cfgs;
+    ClusterSummary *out;
+    int count;
+    atomic_int next;
+} ClusterSweep;
+
+static void * cluster_sweep_worker(void *arg) {
+    ClusterSweep *sw = (ClusterSweep*) arg;
+    int k;
+    while ((k = atomic_fetch_add(&sw->next, 1)) < sw->count) {
+        simulate_cluster(sw->alg, "", sw->reqs, sw->n, &sw->cfgs[k], 0, &sw->out[k]);
+    }
+    return NULL;
+}
+
+static void run_cluster_sweep(const char *alg, const char *label, const Process *reqs, int n,
+                              const ClusterConfig *cfgs, int count, int threads) {
+    ClusterSweep sw = { alg, reqs, n, cfgs, NULL, count, 0 };
+    sw.out = (ClusterSummary*) calloc(count, sizeof(ClusterSummary));
+    if (threads > count) threads = count;
+    pthread_t *tids = (pthread_t*) malloc(sizeof(pthread_t) * threads);
+    double t0 = real_now();
+    for (int t = 0; t < threads; ++t) pthread_create(&tids[t], NULL, cluster_sweep_worker, &sw);
+    for (int t = 0; t < threads; ++t) pthread_join(tids[t], NULL);
+    double wall = real_now() - t0;
+
+    printf("\n=== Autoscaling (algoritmo: %s, cenário: %s, hosts: %d..%d, dispatcher: %s, SLO: %g) ===\n",
+           alg, label, cfgs[0].min_hosts, cfgs[0].hosts, dispatch_names[cfgs[0].policy], cfgs[0].slo);
+    printf("%-6s | %7s | %8s | %8s | %9s | %9s | %8s | %8s | %9s\n", "ctl", "alvo", "arranque", "cooldown",
+           "CPU-horas", "hosts méd", "SLO %", "pico", "p99 ped.");
+    printf("------------------------------------------------------------------------------------------\n");
+    for (int k = 0; k < count; ++k) {
+        const ClusterConfig *c = &cfgs[k];
+        const ClusterSummary *s = &sw.out[k];
+        printf("%-6s | %7.3f | %8.2f | %8.2f | %9.3f | %9.1f | %8.2f | %8d | %9.3f\n", c->ctl->name, c->target,
+               c->delay, c->cooldown, s->host_time / 3600.0, s->makespan > 0.0 ? s->host_time / s->makespan : 0.0,
+               100.0 * s->slo_met, s->peak_hosts, s->req_p99);
+    }
+    printf("------------------------------------------------------------------------------------------\n");
+    printf("%d configurações em %.2f s com %d threads\n", count, wall, threads);
+    free(tids);
+    free(sw.out);
+}
+
+/* ------------------- Afinação de MLFQ (tune) ------------------- */
+
+#define TUNE_MAX_LEVELS 5
+#define TUNE_FINALISTS 16   /* sobreviventes que chegam ao traço completo */
+#define TUNE_REFINE_STEPS 8
+
+static const double tune_quanta[] = { 0.05, 0.1, 0.25, 0.5, 1.0, 2.0, 4.0, 8.0 };
+static const double tune_boosts[] = { 0.0, 1.0, 2.0, 5.0, 10.0, 20.0, 50.0 };
+#define N_TUNE_QUANTA ((int) (sizeof(tune_quanta) / sizeof(tune_quanta[0])))
+#define N_TUNE_BOOSTS ((int) (sizeof(tune_boosts) / sizeof(tune_boosts[0])))
+
+typedef struct {
+    int levels;
+    double quantum[TUNE_MAX_LEVELS];
+    double boost;       /* período do priority boost, 0: sem boost */
+    int sjf;            /* um nível ordenado por CPU total (quantum infinito) */
+} MlfqParams;
+
+typedef struct {
+    double p99;         /* p99 de Elapsed */
+    double resp;        /* FirstRun médio */
+    double score;       /* weight * p99 + resp */
+    double starvation;  /* maior espera seguida na fila de prontos */
+    double slowdown;    /* maior Elapsed / CPU */
+} TuneScore;
+
+/* Espaço de trabalho de uma thread, com n entradas */
+typedef struct {
+    Process *ps;
+    double *elapsed;
+    double *ready;      /* desde quando cada processo espera na fila */
+} EvalScratch;
+
+static void scratch_init(EvalScratch *sc, int n) {
+    sc->ps = (Process*) malloc(sizeof(Process) * n);
+    sc->elapsed = (double*) malloc(sizeof(double) * n);
+    sc->ready = (double*) malloc(sizeof(double) * n);
+}
+
+static void scratch_free(EvalScratch *sc) {
+    free(sc->ps);
+    free(sc->elapsed);
+    free(sc->ready);
+}
+
+static void eval_push(ProcQueue *q, const MlfqParams *mp, Process *p) {
+    if (mp->sjf) sjf_push(q, p);
+    else pq_push(q, p);
+}
+
+/* MLFQ de um CPU com chegadas, níveis/quanta por nível e boost periódico
+ * (todos voltam à fila 0). Com 3 níveis de QUANTUM, sem boost e chegadas a
+ * 0 faz o mesmo que run_mlfq; com um nível é rr (ou fifo com quantum
+ * infinito, ou sjf). Com quantum infinito não há preempção: como no fifo/sjf
+ * do simulador o processo segura o CPU nos IO e corre até ao fim.
+ * trace vem por ordem de chegada. */
+static void mlfq_eval(const Process *trace, int n, const MlfqParams *mp, double weight,
+                      EvalScratch *sc, TuneScore *out) {
+    ProcQueue q[TUNE_MAX_LEVELS];
+    memset(q, 0, sizeof(q));
+    Process *ps = sc->ps;
+    double *elapsed = sc->elapsed, *ready = sc->ready;
+    for (int i = 0; i < n; ++i) {
+        ps[i] = trace[i];
+        reset_process(&ps[i], i);
+        ready[i] = ps[i].arrival;
+    }
+    double t = 0.0, next_boost = mp->boost > 0.0 ? mp->boost : INFINITY, resp = 0.0;
+    out->starvation = 0.0;
+    out->slowdown = 0.0;
+    Process *last = NULL;
+    int next = 0, done = 0;
+    while (done < n) {
+        while (next < n && ps[next].arrival <= t + EPS) eval_push(&q[0], mp, &ps[next++]);
+        if (t >= next_boost) {
+            for (int l = 1; l < mp->levels; ++l) {
+                while (q[l].len > 0) {
+                    Process *p = pq_pop(&q[l]);
+                    p->level = 0;
+                    pq_push(&q[0], p);
+                }
+            }
+            while (next_boost <= t) next_boost += mp->boost;
+        }
+        int l = 0;
+        while (l < mp->levels && q[l].len == 0) l++;
+        if (l == mp->levels) {
+            t = ps[next].arrival;
+            continue;
+        }
+        Process *p = mp->sjf ? sjf_pop(&q[l]) : pq_pop(&q[l]);
+        if (t - ready[p->id] > out->starvation) out->starvation = t - ready[p->id];
+        dispatch(p, &last, &t);
+        double taken, io_dur;
+        do {
+            eat_cpu(p, isinf(mp->quantum[l]) ? p->remaining : mp->quantum[l], &taken, &io_dur);
+            t += taken;
+            if (io_dur >= 0.0) t += io_dur;
+        } while (isinf(mp->quantum[l]) && !is_done(p));
+        if (is_done(p)) {
+            p->finish_time = t;
+            elapsed[done++] = t - p->arrival;
+            resp += p->first_run_time - p->arrival;
+            double slow = (t - p->arrival) / p->total_cpu_needed;
+            if (slow > out->slowdown) out->slowdown = slow;
+        } else {
+            p->level = mlfq_next_level(l, taken > mp->quantum[l] - 1e-9, mp->levels);
+            ready[p->id] = t;
+            /* quem chegou durante o slice entra antes de p, como em cpu_slice */
+            while (next < n && ps[next].arrival <= t + EPS) eval_push(&q[0], mp, &ps[next++]);
+            eval_push(&q[p->level], mp, p);
+        }
+    }
+    for (int l = 0; l < TUNE_MAX_LEVELS; ++l) free(q[l].items);
+    qsort(elapsed, n, sizeof(double), cmp_double);
+    out->p99 = elapsed[(int) (0.99 * (n - 1))];
+    out->resp = resp / n;
+    out->score = weight * out->p99 + out->resp;
+}
+
+/* Um lote de candidatos avaliado no mesmo troço do traço por T threads */
+typedef struct {
+    const Process *trace;
+    int n;
+    double weight;
+    const MlfqParams *cands;
+    TuneScore *out;
+    int count;
+    atomic_int next;
+} TuneBatch;
+
+static void * tune_worker(void *arg) {
+    TuneBatch *b = (TuneBatch*) arg;
+    EvalScratch sc;
+    scratch_init(&sc, b->n);
+    int k;
+    while ((k = atomic_fetch_add(&b->next, 1)) < b->count) {
+        mlfq_eval(b->trace, b->n, &b->cands[k], b->weight, &sc, &b->out[k]);
+    }
+    scratch_free(&sc);
+    return NULL;
+}
+
+static void tune_batch(const Process *trace, int n, double weight, const MlfqParams *cands,
+                       TuneScore *out, int count, int threads) {
+    TuneBatch b = { trace, n, weight, cands, out, count, 0 };
+    if (threads > count) threads = count;
+    pthread_t *tids = (pthread_t*) malloc(sizeof(pthread_t) * threads);
+    for (int t = 1; t < threads; ++t) pthread_create(&tids[t], NULL, tune_worker, &b);
+    tune_worker(&b);
+    for (int t = 1; t < threads; ++t) pthread_join(tids[t], NULL);
+    free(tids);
+}
+
+/* Quanta não decrescentes por nível (grelha tune_quanta) x boosts */
+static int tune_space(MlfqParams *out) {
+    int count = 0;
+    for (int levels = 1; levels <= TUNE_MAX_LEVELS; ++levels) {
+        int idx[TUNE_MAX_LEVELS] = { 0 };
+        for (;;) {
+            for (int b = 0; b < N_TUNE_BOOSTS; ++b) {
+                if (levels == 1 && b > 0) break;   /* boost não muda nada com um nível */
+                if (out) {
+                    MlfqParams *mp = &out[count];
+                    mp->levels = levels;
+                    for (int l = 0; l < levels; ++l) mp->quantum[l] = tune_quanta[idx[l]];
+                    mp->boost = tune_boosts[b];
+                    mp->sjf = 0;
+                }
+                count++;
+            }
+            int l = levels - 1;
+            while (l >= 0 && idx[l] == N_TUNE_QUANTA - 1) l--;
+            if (l < 0) break;
+            idx[l]++;
+            for (int m = l + 1; m < levels; ++m) idx[m] = idx[l];
+        }
+    }
+    return count;
+}
+
+/* Vizinhos para o refinamento: cada quantum x/÷1.5, boost x/÷2 (ou ligar),
+ * um nível a mais (repete o último) ou a menos */
+static int tune_neighbours(const MlfqParams *mp, MlfqParams *out) {
+    int count = 0;
+    for (int l = 0; l < mp->levels; ++l) {
+        out[count] = *mp;
+        out[count++].quantum[l] *= 1.5;
+        out[count] = *mp;
+        out[count++].quantum[l] /= 1.5;
+    }
+    out[count] = *mp;
+    out[count++].boost = mp->boost > 0.0 ? mp->boost * 2.0 : 10.0;
+    if (mp->boost > 0.0) {
+        out[count] = *mp;
+        out[count++].boost = mp->boost / 2.0;
+        out[count] = *mp;
+        out[count++].boost = 0.0;
+    }
+    if (mp->levels < TUNE_MAX_LEVELS) {
+        out[count] = *mp;
+        out[count].quantum[mp->levels] = mp->quantum[mp->levels - 1];
+        out[count++].levels++;
+    }
+    if (mp->levels > 1) {
+        out[count] = *mp;
+        out[count++].levels--;
+    }
+    return count;
+}
+
+typedef struct {
+    MlfqParams mp;
+    TuneScore sc;
+} TuneEntry;
+
+static int cmp_tune_score(const void *a, const void *b) {
+    double x = ((const TuneEntry*) a)->sc.score, y = ((const TuneEntry*) b)->sc.score;
+    return (x > y) - (x < y);
+}
+
+static int cmp_tune_p99(const void *a, const void *b) {
+    const TuneEntry *x = (const TuneEntry*) a, *y = (const TuneEntry*) b;
+    if (x->sc.p99 != y->sc.p99) return x->sc.p99 < y->sc.p99 ? -1 : 1;
+    return (x->sc.resp > y->sc.resp) - (x->sc.resp < y->sc.resp);
+}
+
+static void print_tune_entry(const TuneEntry *e) {
+    char quanta[64];
+    int len = 0;
+    for (int l = 0; l < e->mp.levels; ++l) {
+        len += snprintf(quanta + len, sizeof(quanta) - len, "%s%.3g", l ? "/" : "", e->mp.quantum[l]);
+    }
+    printf("%6d | %-24s | %6g | %9.3f | %9.3f | %9.3f\n", e->mp.levels, quanta, e->mp.boost,
+           e->sc.p99, e->sc.resp, e->sc.score);
+}
+
+/* Successive halving: todos os candidatos em janelas pequenas do traço,
+ * fica 1/eta em cada ronda e a janela cresce eta vezes, até restarem
+ * TUNE_FINALISTS, que correm o traço completo. Depois, subida de encosta
+ * a partir do melhor no traço completo. Todas as avaliações completas
+ * entram no arquivo de onde sai a fronteira de Pareto (p99 x FirstRun). */
+static void run_tune(const char *label, Process *base, int n, double weight, int eta, int threads) {
+    Process *trace = (Process*) malloc(sizeof(Process) * n);
+    Process **order = (Process**) malloc(sizeof(Process*) * n);
+    for (int i = 0; i < n; ++i) order[i] = &base[i];
+    qsort(order, n, sizeof(Process*), cmp_arrival);
+    for (int i = 0; i < n; ++i) trace[i] = *order[i];
+    free(order);
+
+    int count = tune_space(NULL);
+    MlfqParams *cands = (MlfqParams*) malloc(sizeof(MlfqParams) * count);
+    tune_space(cands);
+    TuneEntry *entries = (TuneEntry*) malloc(sizeof(TuneEntry) * count);
+    TuneScore *scores = (TuneScore*) malloc(sizeof(TuneScore) * count);
+
+    int rounds = 0;
+    for (int c = count; c > TUNE_FINALISTS; c = (c + eta - 1) / eta) rounds++;
+
+    printf("\n=== Tune MLFQ (cenário: %s, jobs: %d, objetivo: %g * p99 + FirstRun médio, threads: %d) ===\n",
+           label, n, weight, threads);
+    printf("%5s | %8s | %10s | %9s | %8s\n", "ronda", "janela", "candidatos", "melhor", "tempo s");
+    printf("--------------------------------------------------\n");
+    double t0 = real_now();
+    for (int r = 0; r <= rounds; ++r) {
+        /* janela contígua a meio do traço; a última ronda usa-o todo */
+        int window = n;
+        for (int k = r; k < rounds; ++k) window /= eta;
+        if (window < 100) window = n < 100 ? n : 100;
+        const Process *w = trace + (n - window) / 2;
+        double tr = real_now();
+        tune_batch(w, window, weight, cands, scores, count, threads);
+        for (int k = 0; k < count; ++k) entries[k] = (TuneEntry) { cands[k], scores[k] };
+        qsort(entries, count, sizeof(TuneEntry), cmp_tune_score);
+        printf("%5d | %8d | %10d | %9.3f | %8.2f\n", r, window, count, entries[0].sc.score, real_now() - tr);
+        if (r < rounds) {
+            count = (count + eta - 1) / eta;
+            for (int k = 0; k < count; ++k) cands[k] = entries[k].mp;
+        }
+    }
+
+    /* arquivo das avaliações no traço completo */
+    int arch_cap = count + TUNE_REFINE_STEPS * 2 * (2 * TUNE_MAX_LEVELS + 5), arch_len = count;
+    TuneEntry *archive = (TuneEntry*) malloc(sizeof(TuneEntry) * arch_cap);
+    memcpy(archive, entries, sizeof(TuneEntry) * count);
+    TuneEntry best = entries[0];
+    MlfqParams nb[2 * TUNE_MAX_LEVELS + 5];
+    TuneScore nbs[2 * TUNE_MAX_LEVELS + 5];
+    int steps = 0;
+    for (; steps < TUNE_REFINE_STEPS; ++steps) {
+        int m = tune_neighbours(&best.mp, nb);
+        tune_batch(trace, n, weight, nb, nbs, m, threads);
+        int improved = -1;
+        for (int k = 0; k < m; ++k) {
+            archive[arch_len++] = (TuneEntry) { nb[k], nbs[k] };
+            if (nbs[k].score < best.sc.score - 1e-12 && (improved < 0 || nbs[k].score < nbs[improved].score)) improved = k;
+        }
+        if (improved < 0) break;
+        best = (TuneEntry) { nb[improved], nbs[improved] };
+    }
+    printf("--------------------------------------------------\n");
+    printf("refinamento: %d passos no traço completo, %.2f s no total\n", steps, real_now() - t0);
+
+    /* fronteira: por p99 crescente, fica quem melhora o FirstRun */
+    qsort(archive, arch_len, sizeof(TuneEntry), cmp_tune_p99);
+    printf("\nFronteira de Pareto (p99 de Elapsed x FirstRun médio):\n");
+    printf("%6s | %-24s | %6s | %9s | %9s | %9s\n", "níveis", "quanta", "boost", "p99", "FirstRun", "objetivo");
+    printf("-----------------------------------------------------------------------------\n");
+    double best_resp = INFINITY;
+    for (int k = 0; k < arch_len; ++k) {
+        if (archive[k].sc.resp < best_resp - 1e-12) {
+            print_tune_entry(&archive[k]);
+            best_resp = archive[k].sc.resp;
+        }
+    }
+    printf("-----------------------------------------------------------------------------\n");
+
+    MlfqParams ref = { MLFQ_LEVELS, { 0 }, 0.0, 0 };
+    for (int l = 0; l < MLFQ_LEVELS; ++l) ref.quantum[l] = QUANTUM;
+    TuneEntry reference = { ref, { 0, 0, 0, 0, 0 } };
+    tune_batch(trace, n, weight, &ref, &reference.sc, 1, 1);
+    printf("melhor:     ");
+    print_tune_entry(&best);
+    printf("referência: ");
+    print_tune_entry(&reference);
+
+    free(archive);
+    free(entries);
+    free(scores);
+    free(cands);
+    free(trace);
+}
+
+/* ------------------- Procura adversária de cargas ------------------- */
+
+#define ADV_MAX_PROCS 64
+#define ADV_MAX_IO 6
+#define ADV_CPU_MIN 0.1
+#define ADV_CPU_MAX 10.0
+#define ADV_ARRIVAL_MAX 30.0
+#define ADV_IO_MAX 3.0
+
+typedef enum { ADV_STARVATION, ADV_P99, ADV_SLOWDOWN, N_ADV_METRICS } AdvMetric;
+static const char *adv_metric_names[N_ADV_METRICS] = { "starvation", "p99", "slowdown" };
+
+typedef struct {
+    double cpu, arrival;
+    int io_count;
+    IOEvent io[ADV_MAX_IO];   /* when_cpu crescente, < cpu */
+} AdvProc;
+
+/* Um candidato: n processos com CPU total limitado a budget */
+typedef struct {
+    AdvProc procs[ADV_MAX_PROCS];
+    TuneScore sc;
+    double badness;
+} AdvGenome;
+
+typedef struct {
+    int n;
+    double budget;
+    MlfqParams policy;
+    AdvMetric metric;
+    AdvGenome *pop;
+    int count;
+    atomic_int next;
+    int stop;
+    pthread_barrier_t start, done;
+} AdvSearch;
+
+static double adv_badness(const AdvSearch *as, const TuneScore *sc) {
+    switch (as->metric) {
+    case ADV_STARVATION: return sc->starvation;
+    case ADV_P99: return sc->p99;
+    default: return sc->slowdown;
+    }
+}
+
+/* Empates na chegada pelo índice no genoma (P2 antes de P10) */
+static int cmp_adv_proc(const void *a, const void *b) {
+    const Process *x = (const Process*) a, *y = (const Process*) b;
+    if (x->arrival != y->arrival) return x->arrival < y->arrival ? -1 : 1;
+    return x->id - y->id;
+}
+
+/* Genoma -> traço por ordem de chegada (IO aponta para o genoma) */
+static void adv_trace(AdvGenome *g, int n, Process *trace) {
+    for (int i = 0; i < n; ++i) {
+        Process *p = &trace[i];
+        memset(p, 0, sizeof(*p));
+        snprintf(p->name, sizeof(p->name), "P%d", i);
+        p->total_cpu_needed = g->procs[i].cpu;
+        p->arrival = g->procs[i].arrival;
+        p->io_events = g->procs[i].io;
+        p->io_count = g->procs[i].io_count;
+        p->fanout = 1;
+        p->id = i;
+    }
+    qsort(trace, n, sizeof(Process), cmp_adv_proc);
+}
+
+static void adv_evaluate(AdvSearch *as, EvalScratch *sc, Process *trace) {
+    int k;
+    while ((k = atomic_fetch_add(&as->next, 1)) < as->count) {
+        AdvGenome *g = &as->pop[k];
+        adv_trace(g, as->n, trace);
+        mlfq_eval(trace, as->n, &as->policy, 1.0, sc, &g->sc);
+        g->badness = adv_badness(as, &g->sc);
+    }
+}
+
+/* Pool fixo: cada geração a thread principal abre a barreira start,
+ * todas avaliam candidatos do contador atómico e encontram-se em done */
+static void * adv_worker(void *arg) {
+    AdvSearch *as = (AdvSearch*) arg;
+    EvalScratch sc;
+    scratch_init(&sc, as->n);
+    Process *trace = (Process*) malloc(sizeof(Process) * as->n);
+    for (;;) {
+        pthread_barrier_wait(&as->start);
+        if (as->stop) break;
+        adv_evaluate(as, &sc, trace);
+        pthread_barrier_wait(&as->done);
+    }
+    free(trace);
+    scratch_free(&sc);
+    return NULL;
+}
+
+static int cmp_io(const void *a, const void *b) {
+    double x = ((const IOEvent*) a)->when_cpu, y = ((const IOEvent*) b)->when_cpu;
+    return (x > y) - (x < y);
+}
+
+/* Repõe as restrições: CPU e IO dentro dos limites, IO antes do fim do
+ * processo e por ordem, CPU total <= budget */
+static void adv_repair(AdvGenome *g, int n, double budget) {
+    double total = 0.0;
+    for (int i = 0; i < n; ++i) {
+        AdvProc *p = &g->procs[i];
+        if (p->cpu < ADV_CPU_MIN) p->cpu = ADV_CPU_MIN;
+        if (p->cpu > ADV_CPU_MAX) p->cpu = ADV_CPU_MAX;
+        if (p->arrival < 0.0) p->arrival = 0.0;
+        if (p->arrival > ADV_ARRIVAL_MAX) p->arrival = ADV_ARRIVAL_MAX;
+        total += p->cpu;
+    }
+    for (int i = 0; i < n; ++i) {
+        AdvProc *p = &g->procs[i];
+        if (total > budget) p->cpu *= budget / total;
+        int m = 0;
+        for (int e = 0; e < p->io_count; ++e) {
+            IOEvent ev = p->io[e];
+            if (ev.duration > ADV_IO_MAX) ev.duration = ADV_IO_MAX;
+            if (ev.duration < 0.0) ev.duration = 0.0;
+            if (ev.when_cpu > 0.0 && ev.when_cpu < p->cpu) p->io[m++] = ev;
+        }
+        p->io_count = m;
+        qsort(p->io, m, sizeof(IOEvent), cmp_io);
+    }
+}
+
+static double adv_uniform(uint64_t *rng, double lo, double hi) {
+    return lo + (hi - lo) * rng_uniform(rng);
+}
+
+static void adv_random(AdvGenome *g, int n, double budget, uint64_t *rng) {
+    for (int i = 0; i < n; ++i) {
+        AdvProc *p = &g->procs[i];
+        p->cpu = exp(adv_uniform(rng, log(ADV_CPU_MIN), log(ADV_CPU_MAX)));
+        p->arrival = rng_uniform(rng) < 0.5 ? 0.0 : adv_uniform(rng, 0.0, ADV_ARRIVAL_MAX);
+        p->io_count = (int) (rng_next(rng) % (ADV_MAX_IO + 1));
+        for (int e = 0; e < p->io_count; ++e) {
+            p->io[e] = (IOEvent) { adv_uniform(rng, 0.0, p->cpu), adv_uniform(rng, 0.0, ADV_IO_MAX) };
+        }
+    }
+    adv_repair(g, n, budget);
+}
+
+/* Uma mutação: comprimento de um burst, colocação/duração de um IO, um IO
+ * a mais ou a menos, uma rajada de chegadas ou uma chegada deslocada */
+static void adv_mutate(AdvGenome *g, int n, uint64_t *rng) {
+    AdvProc *p = &g->procs[rng_next(rng) % (uint64_t) n];
+    switch (rng_next(rng) % 6) {
+    case 0:
+        p->cpu *= pow(4.0, adv_uniform(rng, -1.0, 1.0));
+        break;
+    case 1:
+        if (p->io_count > 0) {
+            IOEvent *ev = &p->io[rng_next(rng) % (uint64_t) p->io_count];
+            if (rng_uniform(rng) < 0.5) ev->when_cpu = adv_uniform(rng, 0.0, p->cpu);
+            else ev->duration *= pow(4.0, adv_uniform(rng, -1.0, 1.0));
+        }
+        break;
+    case 2:
+        if (p->io_count < ADV_MAX_IO) {
+            p->io[p->io_count++] = (IOEvent) { adv_uniform(rng, 0.0, p->cpu), adv_uniform(rng, 0.0, ADV_IO_MAX) };
+        }
+        break;
+    case 3:
+        if (p->io_count > 0) {
+            int e = (int) (rng_next(rng) % (uint64_t) p->io_count);
+            p->io[e] = p->io[--p->io_count];
+        }
+        break;
+    case 4: {
+        double t = adv_uniform(rng, 0.0, ADV_ARRIVAL_MAX);
+        int burst = 2 + (int) (rng_next(rng) % (uint64_t) (n > 2 ? n - 1 : 1));
+        for (int k = 0; k < burst; ++k) g->procs[rng_next(rng) % (uint64_t) n].arrival = t;
+        break;
+    }
+    default:
+        p->arrival += adv_uniform(rng, -5.0, 5.0);
+        break;
+    }
+}
+
+static const AdvGenome * adv_tournament(const AdvGenome *pop, int count, uint64_t *rng) {
+    const AdvGenome *best = &pop[rng_next(rng) % (uint64_t) count];
+    for (int k = 1; k < 3; ++k) {
+        const AdvGenome *c = &pop[rng_next(rng) % (uint64_t) count];
+        if (c->badness > best->badness) best = c;
+    }
+    return best;
+}
+
+static int cmp_adv_badness(const void *a, const void *b) {
+    double x = ((const AdvGenome*) a)->badness, y = ((const AdvGenome*) b)->badness;
+    return (x < y) - (x > y);
+}
+
+/* Escreve o traço pela ordem em que foi avaliado: o simulador desempata
+ * chegadas iguais pela ordem no ficheiro */
+static int write_adv_scenario(const char *path, const Process *trace, int n, double badness,
+                              const char *alg, const char *metric) {
+    FILE *f = fopen(path, "w");
+    if (!f) return -1;
+    fprintf(f, "# pior carga encontrada para %s (%s = %.3f)\n", alg, metric, badness);
+    for (int i = 0; i < n; ++i) {
+        const Process *p = &trace[i];
+        fprintf(f, "%s %.17g arrival=%.17g", p->name, p->total_cpu_needed, p->arrival);
+        for (int e = 0; e < p->io_count; ++e) {
+            fprintf(f, "%s%.17g:%.17g", e ? "," : " io=", p->io_events[e].when_cpu, p->io_events[e].duration);
+        }
+        fprintf(f, "\n");
+    }
+    fclose(f);
+    return 0;
+}
+
+/* Algoritmo genético: população pop_size, elitismo (1/8), torneio de 3,
+ * cruzamento uniforme por processo e 1..3 mutações por filho. A avaliação
+ * corre no pool; a reprodução é sequencial e reprodutível pela semente. */
+static int run_adversary(const char *alg, AdvMetric metric, int n, double budget, int pop_size, int gens,
+                         int top, int threads, uint64_t seed, const char *prefix) {
+    AdvSearch as;
+    memset(&as, 0, sizeof(as));
+    as.n = n;
+    as.budget = budget;
+    as.metric = metric;
+    as.count = pop_size;
+    MlfqParams *mp = &as.policy;
+    mp->levels = strcmp(alg, "mlfq") == 0 ? MLFQ_LEVELS : 1;
+    for (int l = 0; l < mp->levels; ++l) mp->quantum[l] = QUANTUM;
+    if (strcmp(alg, "fifo") == 0 || strcmp(alg, "sjf") == 0) mp->quantum[0] = INFINITY;
+    mp->sjf = strcmp(alg, "sjf") == 0;
+
+    AdvGenome *pop = (AdvGenome*) malloc(sizeof(AdvGenome) * pop_size);
+    AdvGenome *kids = (AdvGenome*) malloc(sizeof(AdvGenome) * pop_size);
+    uint64_t rng = seed;
+    for (int i = 0; i < pop_size; ++i) adv_random(&pop[i], n, budget, &rng);
+
+    pthread_barrier_init(&as.start, NULL, threads);
+    pthread_barrier_init(&as.done, NULL, threads);
+    pthread_t *tids = (pthread_t*) malloc(sizeof(pthread_t) * threads);
+    for (int t = 1; t < threads; ++t) pthread_create(&tids[t], NULL, adv_worker, &as);
+    EvalScratch sc;
+    scratch_init(&sc, n);
+    Process *trace = (Process*) malloc(sizeof(Process) * n);
+
+    printf("\n=== Procura adversária (algoritmo: %s, métrica: %s, processos: %d, CPU total <= %g) ===\n",
+           alg, adv_metric_names[metric], n, budget);
+    printf("%7s | %10s | %10s\n", "geração", "pior", "mediana");
+    printf("-------------------------------\n");
+    double t0 = real_now();
+    int elite = pop_size / 8 > 0 ? pop_size / 8 : 1;
+    for (int gen = 0; gen <= gens; ++gen) {
+        as.pop = pop;
+        atomic_store(&as.next, 0);
+        pthread_barrier_wait(&as.start);
+        adv_evaluate(&as, &sc, trace);
+        pthread_barrier_wait(&as.done);
+        qsort(pop, pop_size, sizeof(AdvGenome), cmp_adv_badness);
+        if (gen % 10 == 0 || gen == gens) {
+            printf("%7d | %10.3f | %10.3f\n", gen, pop[0].badness, pop[pop_size / 2].badness);
+        }
+        if (gen == gens) break;
+
+        for (int i = 0; i < elite; ++i) kids[i] = pop[i];
+        for (int i = elite; i < pop_size; ++i) {
+            const AdvGenome *a = adv_tournament(pop, pop_size, &rng);
+            const AdvGenome *b = adv_tournament(pop, pop_size, &rng);
+            for (int k = 0; k < n; ++k) kids[i].procs[k] = rng_uniform(&rng) < 0.5 ? a->procs[k] : b->procs[k];
+            int mutations = 1 + (int) (rng_next(&rng) % 3);
+            for (int m = 0; m < mutations; ++m) adv_mutate(&kids[i], n, &rng);
+            adv_repair(&kids[i], n, budget);
+        }
+        AdvGenome *swap = pop;
+        pop = kids;
+        kids = swap;
+    }
+    double wall = real_now() - t0;
+    as.stop = 1;
+    pthread_barrier_wait(&as.start);
+    for (int t = 1; t < threads; ++t) pthread_join(tids[t], NULL);
+    printf("-------------------------------\n");
+    printf("%d avaliações em %.2f s com %d threads (%.0f cargas/s)\n", (gens + 1) * pop_size, wall, threads,
+           (gens + 1) * pop_size / wall);
+
+    /* as piores cargas distintas, escritas como cenários */
+    if (top > pop_size) top = pop_size;
+    printf("%-25s | %10s | %10s | %10s | %10s\n", "cenário", "starvation", "p99", "slowdown", "FirstRun");
+    int written = 0, rc = 0;
+    for (int i = 0; i < pop_size && written < top; ++i) {
+        if (i > 0 && memcmp(pop[i].procs, pop[i - 1].procs, sizeof(AdvProc) * n) == 0) continue;
+        char path[512];
+        snprintf(path, sizeof(path), "%s%d.txt", prefix, ++written);
+        adv_trace(&pop[i], n, trace);
+        if (write_adv_scenario(path, trace, n, pop[i].badness, alg, adv_metric_names[metric]) != 0) {
+            fprintf(stderr, "Não foi possível escrever %s\n", path);
+            rc = 1;
+            break;
+        }
+        printf("%-24s | %10.3f | %10.3f | %10.3f | %10.3f\n", path, pop[i].sc.starvation, pop[i].sc.p99,
+               pop[i].sc.slowdown, pop[i].sc.resp);
+    }
+
+    scratch_free(&sc);
+    free(trace);
+    free(tids);
+    free(pop);
+    free(kids);
+    pthread_barrier_destroy(&as.start);
+    pthread_barrier_destroy(&as.done);
+    return rc;
+}
+
+static int valid_algorithm(const char *alg) {
+    return strcmp(alg, "fifo") == 0 || strcmp(alg, "sjf") == 0
+        || strcmp(alg, "rr") == 0 || strcmp(alg, "mlfq") == 0;
+}
+
+/* Executa um algoritmo pelo nome; NULL se o nome for inválido */
+static Result* run_algorithm(const char *alg, Process *base, int n, int *out_count) {
+    int arrivals = 0;
+    for (int i = 0; i < n; ++i) if (base[i].arrival > 0.0) arrivals = 1;
+    if (sim_cpus == 1 && (strcmp(alg, "fifo") == 0 || (strcmp(alg, "sjf") == 0 && !arrivals))) {
+        return run_closed_form(alg, base, n, (int) sysconf(_SC_NPROCESSORS_ONLN), out_count);
+    }
+    if (valid_algorithm(alg) && (sim_cpus > 1 || arrivals)) return run_multi(alg, base, n, out_count);
+    if (strcmp(alg, "rr") == 0) return run_rr(base, n, out_count);
+    if (strcmp(alg, "mlfq") == 0) return run_mlfq(base, n, out_count);
+    return NULL;
+}
+
+/* -x/-i aceitam um valor ou um ficheiro chave=valor (ctxsw/ctxsw.c -o,
+ * ./simulador stream -o) de onde se lê `key` */
+static int load_param(const char *arg, const char *key, double *out) {
+    char *end;
+    double v = strtod(arg, &end);
+    if (end != arg && *end == '\0') {
+        *out = v;
+        return v >= 0.0 ? 0 : -1;
+    }
+    FILE *f = fopen(arg, "r");
+    if (!f) return -1;
+    char line[256];
+    size_t klen = strlen(key);
+    int found = 0;
+    while (fgets(line, sizeof(line), f)) {
+        if (strncmp(line, key, klen) == 0 && line[klen] == '=' && sscanf(line + klen + 1, "%lf", &v) == 1 && v >= 0.0) {
+            *out = v;
+            found = 1;
+        }
+    }
+    fclose(f);
+    return found ? 0 : -1;
+}
+
+/* ------------------- Modelos analíticos ------------------- */
+
+/* Previsões instantâneas a partir dos momentos medidos no traço (serviço
+ * solo = CPU + IO, que segura o CPU; intervalos entre chegadas):
+ *  - M/G/k FCFS: espera de M/M/k (Erlang C) escalada por (1 + c_s²)/2,
+ *    que com k = 1 é exatamente Pollaczek-Khinchine;
+ *  - M/G/k PS: insensível à distribuição do serviço, o mesmo número médio
+ *    no sistema que M/M/k;
+ *  - MVA com a aproximação de Seidmann (k CPUs = fila com procura D/k mais
+ *    atraso D(k-1)/k): aberto com chegadas, R = (D/k)/(1 - rho) + D(k-1)/k;
+ *    sem chegadas, MVA fechado para N = n..1 e o lote escoa a X(m) por
+ *    conclusão. */
+
+typedef struct {
+    int n, k;
+    double lambda, ca2;       /* taxa de chegada e SCV dos intervalos (0 sem chegadas) */
+    double mean, cs2;         /* E[S] e SCV do serviço */
+    double rho;
+} Moments;
+
+typedef struct {
+    char model[24];
+    double elapsed, first_run, in_system;
+} Prediction;
+
+static Moments fit_moments(Process *base, int n, int k) {
+    Moments m = { n, k, 0.0, 0.0, 0.0, 0.0, 0.0 };
+    int *order = (int*) malloc(sizeof(int) * n);
+    for (int i = 0; i < n; ++i) order[i] = i;
+    qsort_r(order, n, sizeof(int), cmp_index_arrival, base);
+    double s1 = 0.0, s2 = 0.0, g1 = 0.0, g2 = 0.0;
+    for (int j = 0; j < n; ++j) {
+        double cpu, io, s = solo_service(&base[order[j]], &cpu, &io);
+        s1 += s;
+        s2 += s * s;
+        if (j > 0) {
+            double g = base[order[j]].arrival - base[order[j - 1]].arrival;
+            g1 += g;
+            g2 += g * g;
+        }
+    }
+    free(order);
+    m.mean = n ? s1 / n : 0.0;
+    m.cs2 = m.mean > 0.0 ? (s2 / n) / (m.mean * m.mean) - 1.0 : 0.0;
+    if (n > 1 && g1 > 0.0) {
+        double gap = g1 / (n - 1);
+        m.lambda = 1.0 / gap;
+        m.ca2 = (g2 / (n - 1)) / (gap * gap) - 1.0;
+        m.rho = m.lambda * m.mean / k;
+    }
+    return m;
+}
+
+/* Erlang C: probabilidade de esperar em M/M/k com carga oferecida a = lambda E[S] */
+static double erlang_c(int k, double a) {
+    double b = 1.0;
+    for (int j = 1; j <= k; ++j) b = a * b / (j + a * b);
+    return k * b / (k - a * (1.0 - b));
+}
+
+/* Devolve quantas previsões escreveu em out (0 se o sistema aberto é instável) */
+static int analytic_predict(const Moments *m, Prediction *out) {
+    double d = m->mean, dq = d / m->k, dd = d * (m->k - 1) / m->k;
+    if (m->lambda <= 0.0) {
+        /* lote a t = 0: MVA fechado, a população desce de n a 1 */
+        double *x = (double*) malloc(sizeof(double) * (m->n + 1));
+        double q = 0.0;
+        for (int pop = 1; pop <= m->n; ++pop) {
+            double r = dq * (1.0 + q) + dd;
+            x[pop] = pop / r;
+            q = x[pop] * dq * (1.0 + q);
+        }
+        double t = 0.0, sum = 0.0;
+        for (int pop = m->n; pop >= 1; --pop) {
+            t += 1.0 / x[pop];
+            sum += t;
+        }
+        free(x);
+        double r = m->n ? sum / m->n : 0.0;
+        out[0] = (Prediction) { "MVA fechado", r, r - d, (m->n + 1) / 2.0 };
+        return 1;
+    }
+    if (m->rho >= 1.0) return 0;
+    double a = m->lambda * d;
+    double c = erlang_c(m->k, a);
+    double wq_mmk = c * d / (m->k * (1.0 - m->rho));
+    double wq = (1.0 + m->cs2) / 2.0 * wq_mmk;
+    out[0] = (Prediction) { "", d + wq, wq, m->lambda * (d + wq) };
+    out[1] = (Prediction) { "", d + wq_mmk, 0.0, m->lambda * (d + wq_mmk) };
+    snprintf(out[0].model, sizeof(out[0].model), "M/G/%d FCFS", m->k);
+    snprintf(out[1].model, sizeof(out[1].model), "M/G/%d PS", m->k);
+    double r = dq / (1.0 - m->rho) + dd;
+    out[2] = (Prediction) { "MVA aberto", r, r - d, m->lambda * r };
+    return 3;
+}
+
+static double mean_field(Result *res, int n, int first_run) {
+    double sum = 0.0;
+    for (int i = 0; i < n; ++i) sum += first_run ? res[i].FirstRun : res[i].Elapsed;
+    return n ? sum / n : 0.0;
+}
+
+/* Previsões para o traço e, com validate > 0, fifo e rr simulados nos
+ * primeiros validate processos (fifo contra FCFS/MVA, rr contra PS) */
+static int run_analytic(const char *label, Process *base, int n, int k, int validate) {
+    double t0 = real_now();
+    Moments m = fit_moments(base, n, k);
+    Prediction pred[3];
+    int np = analytic_predict(&m, pred);
+    double t_model = real_now() - t0;
+    if (np == 0) {
+        fprintf(stderr, "rho = %.3f >= 1: o sistema aberto não tem regime estacionário\n", m.rho);
+        return 1;
+    }
+
+    printf("\n=== Modelos analíticos (cenário: %s, CPUs: %d) ===\n", label, k);
+    if (m.lambda > 0.0) {
+        printf("processos: %d, lambda: %.4f, c_a²: %.3f, E[S]: %.4f, c_s²: %.3f, rho: %.3f\n",
+               n, m.lambda, m.ca2, m.mean, m.cs2, m.rho);
+    } else {
+        printf("processos: %d, todos a 0 (lote), E[S]: %.4f, c_s²: %.3f\n", n, m.mean, m.cs2);
+    }
+    printf("%-14s | %10s | %10s | %10s\n", "Modelo", "Elapsed", "FirstRun", "no sistema");
+    printf("------------------------------------------------------\n");
+    for (int i = 0; i < np; ++i) {
+        printf("%-14s | %10.4f | %10.4f | %10.3f\n", pred[i].model, pred[i].elapsed, pred[i].first_run, pred[i].in_system);
+    }
+    printf("------------------------------------------------------\n");
+    printf("modelos: %.1f µs\n", t_model * 1e6);
+    if (validate <= 0) return 0;
+
+    if (validate > n) validate = n;
+    int saved = sim_cpus;
+    sim_cpus = k;
+    printf("validação (%d processos simulados, %d CPU%s):\n", validate, k, k > 1 ? "s" : "");
+    const char *algs[2] = { "fifo", "rr" };
+    for (int a = 0; a < 2; ++a) {
+        int count;
+        t0 = real_now();
+        Result *res = run_algorithm(algs[a], base, validate, &count);
+        double t_sim = real_now() - t0;
+        double elapsed = mean_field(res, count, 0), first = mean_field(res, count, 1);
+        printf("  %-4s: Elapsed %.4f, FirstRun %.4f (%.3f s)", algs[a], elapsed, first, t_sim);
+        for (int i = 0; i < np; ++i) {
+            if ((a == 1) != (strstr(pred[i].model, "PS") != NULL)) continue;
+            printf(" | %s %+.1f%%", pred[i].model, 100.0 * (pred[i].elapsed - elapsed) / elapsed);
+        }
+        printf("\n");
+        free(res);
+    }
+    sim_cpus = saved;
+    return 0;
+}
+
+/* ------------------- Execução isolada em processos filho ------------------- */
+
+/* Uma tarefa (repetição, ponto de um sweep, ...) escreve até max_rows linhas
+ * em rows e devolve quantas escreveu, ou -1 em caso de erro. Corre num
+ * processo filho: se rebentar ou tiver fugas de memória, só perde essa tarefa. */
+typedef int (*IsolatedTask)(int task, void *ctx, Result *rows, int max_rows);
+
+/* Cabeçalho da região MAP_SHARED; seguem-se int counts[ntasks],
+ * MultiStats stats[ntasks] e Result rows[ntasks * rows_per_task] */
+typedef struct {
+    atomic_int next_task;
+    MultiStats *stats;        /* multi_stats de cada tarefa, para o pai */
+    int current[MAX_WORKERS]; /* tarefa em curso por worker, -1 se nenhuma */
+} IsolatedHeader;
+
+static void isolated_worker(int w, IsolatedHeader *hdr, int *counts, Result *rows,
+                            int ntasks, int rows_per_task, IsolatedTask fn, void *ctx) {
+    int t;
+    while ((t = atomic_fetch_add(&hdr->next_task, 1)) < ntasks) {
+        hdr->current[w] = t;
+        memset(&multi_stats, 0, sizeof(multi_stats));
+        counts[t] = fn(t, ctx, rows + (size_t) t * rows_per_task, rows_per_task);
+        hdr->stats[t] = multi_stats;
+    }
+    hdr->current[w] = -1;
+    _exit(0);
+}
+
+static pid_t fork_isolated_worker(int w, IsolatedHeader *hdr, int *counts, Result *rows,
+                                  int ntasks, int rows_per_task, IsolatedTask fn, void *ctx) {
+    hdr->current[w] = -1;
+    pid_t rc = fork();
+    if (rc == 0) isolated_worker(w, hdr, counts, rows, ntasks, rows_per_task, fn, ctx);
+    return rc;
+}
+
+/* Corre ntasks tarefas em até `workers` processos filho. Devolve um array de
+ * ntasks ponteiros para cópias dos resultados (NULL se a tarefa falhou) e
+ * as contagens de linhas em out_counts. */
+static Result** run_isolated(int ntasks, int rows_per_task, int workers,
+                             IsolatedTask fn, void *ctx, int *out_counts) {
+    if (workers > MAX_WORKERS) workers = MAX_WORKERS;
+    if (workers > ntasks) workers = ntasks;
+    size_t counts_off = sizeof(IsolatedHeader);
+    size_t stats_off = counts_off + sizeof(int) * ntasks;
+    stats_off = (stats_off + 15) & ~(size_t) 15;
+    size_t rows_off = stats_off + sizeof(MultiStats) * ntasks;
+    rows_off = (rows_off + 15) & ~(size_t) 15;
+    size_t bytes = rows_off + sizeof(Result) * (size_t) ntasks * rows_per_task;
+    char *region = (char*) mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (region == MAP_FAILED) return NULL;
+    IsolatedHeader *hdr = (IsolatedHeader*) region;
+    int *counts = (int*) (region + counts_off);
+    Result *rows = (Result*) (region + rows_off);
+    atomic_init(&hdr->next_task, 0);
+    hdr->stats = (MultiStats*) (region + stats_off);
+    for (int t = 0; t < ntasks; ++t) counts[t] = -1;
+
+    pid_t pids[MAX_WORKERS];
+    int alive = 0;
+    fflush(stdout);
+    for (int w = 0; w < workers; ++w) {
+        pids[w] = fork_isolated_worker(w, hdr, counts, rows, ntasks, rows_per_task, fn, ctx);
+        if (pids[w] > 0) alive++;
+    }
+    while (alive > 0) {
+        int status;
+        pid_t pid = waitpid(-1, &status, 0);
+        if (pid < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        int w = -1;
+        for (int i = 0; i < workers; ++i) if (pids[i] == pid) { w = i; break; }
+        if (w < 0) continue;
+        alive--;
+        pids[w] = 0;
+        if (WIFEXITED(status) && WEXITSTATUS(status) == 0) continue;
+        /* worker rebentou: a tarefa em curso fica como falhada, o resto continua */
+        if (hdr->current[w] >= 0) {
+            if (WIFSIGNALED(status))
+                fprintf(stderr, "tarefa %d falhou (sinal %d)\n", hdr->current[w], WTERMSIG(status));
+            else
+                fprintf(stderr, "tarefa %d falhou (exit %d)\n", hdr->current[w], WEXITSTATUS(status));
+            counts[hdr->current[w]] = -1;
+        }
+        if (atomic_load(&hdr->next_task) < ntasks) {
+            pids[w] = fork_isolated_worker(w, hdr, counts, rows, ntasks, rows_per_task, fn, ctx);
+            if (pids[w] > 0) alive++;
+        }
+    }
+
+    Result **out = (Result**) malloc(sizeof(Result*) * ntasks);
+    for (int t = 0; t < ntasks; ++t) {
+        out_counts[t] = counts[t];
+        out[t] = NULL;
+        if (counts[t] < 0) continue;
+        multi_stats = hdr->stats[t]; /* como sem fork: fica a da última tarefa */
+        out[t] = (Result*) malloc(sizeof(Result) * (counts[t] > 0 ? counts[t] : 1));
+        memcpy(out[t], rows + (size_t) t * rows_per_task, sizeof(Result) * counts[t]);
+    }
+    munmap(region, bytes);
+    return out;
+}
+
+/* Contexto das repetições: cada tarefa é uma execução completa do algoritmo */
+typedef struct {
+    const char *alg;
+    Process *base;
+    int n;
+} RepeatCtx;
+
+static int repeat_task(int task, void *ctx, Result *rows, int max_rows) {
+    (void) task;
+    RepeatCtx *rc = (RepeatCtx*) ctx;
+    int count = 0;
+    Result *res = run_algorithm(rc->alg, rc->base, rc->n, &count);
+    if (!res || count > max_rows) return -1;
+    memcpy(rows, res, sizeof(Result) * count);
+    free(res);
+    return count;
+}
+
+/* ------------------- Helper para médias e impressão ------------------- */
+
+static Result* accumulate_results(Result **runs, int run_count, int proc_count) {
+    /* runs is array of pointers length run_count, each points to array proc_count results.
+     * We assume order of processes is same across runs (by name order is not guaranteed),
+     * so we'll average by name matching.
+     */
+    Result *avg = (Result*) malloc(sizeof(Result) * proc_count);
+    for (int i = 0; i < proc_count; ++i) {
+        /* initialize with first run */
+        avg[i] = runs[0][i];
+    }
+    /* build name->index map from first run */
+    /* For simplicity, we'll treat processes in the order of runs[0]. */
+    for (int r = 1; r < run_count; ++r) {
+        for (int i = 0; i < proc_count; ++i) {
+            /* find in runs[r] the same name */
+            int found = -1;
+            if (strcmp(runs[r][i].name, avg[i].name) == 0) found = i; /* mesma ordem: caso comum */
+            for (int j = 0; found < 0 && j < proc_count; ++j) {
+                if (strcmp(runs[r][j].name, avg[i].name) == 0) { found = j; break; }
+            }
+            if (found >= 0) {
+                avg[i].Elapsed += runs[r][found].Elapsed;
+                avg[i].CPU += runs[r][found].CPU;
+                avg[i].BLOCKED += runs[r][found].BLOCKED;
+                avg[i].FirstRun += runs[r][found].FirstRun;
+            } else {
+                /* mismatch; but to be robust, skip */
+            }
+        }
+    }
+    for (int i = 0; i < proc_count; ++i) {
+        avg[i].Elapsed /= run_count;
+        avg[i].CPU /= run_count;
+        avg[i].BLOCKED /= run_count;
+        avg[i].FirstRun /= run_count;
+    }
+    return avg;
+}
+
+static void print_results(const char *algorithm, const char *scenario, Result *avg, int proc_count) {
+    printf("\n=== Resultado médio (algoritmo: %s, cenário: %s) ===\n", algorithm, scenario);
+    printf("%6s | %8s | %8s | %8s | %8s\n", "Proc", "Elapsed", "CPU", "BLOCKED", "FirstRun");
+    printf("--------------------------------------------------------------\n");
+    for (int i = 0; i < proc_count; ++i) {
+        printf("%6s | %8.3f | %8.3f | %8.3f | %8.3f\n",
+               avg[i].name, avg[i].Elapsed, avg[i].CPU, avg[i].BLOCKED, avg[i].FirstRun);
+    }
+    printf("--------------------------------------------------------------\n");
+}
+
+/* ------------------- Modo real (SIGSTOP/SIGCONT) ------------------- */
+
+typedef struct {
+    char name[16];
+    char **argv;
+    pid_t pid;
+    int pidfd;
+    int level;
+    int done;
+    double first_run;  /* -1 se ainda não correu */
+    double finish;
+    double dispatched; /* tempo de parede com o CPU atribuído */
+    struct rusage ru;
+} RealProc;
+
+static double tv_seconds(struct timeval tv) {
+    return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+/* Tempo de CPU (s) do processo segundo /proc/<pid>/schedstat; -1 se indisponível */
+static double schedstat_runtime(pid_t pid) {
+    char path[64], buf[128];
+    snprintf(path, sizeof(path), "/proc/%d/schedstat", (int) pid);
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return -1.0;
+    ssize_t len = read(fd, buf, sizeof(buf) - 1);
+    close(fd);
+    if (len <= 0) return -1.0;
+    buf[len] = '\0';
+    return strtoull(buf, NULL, 10) / 1e9;
+}
+
+/* Divide uma linha de comando em argv (separado por espaços) */
+static char **split_command(const char *cmd) {
+    char *copy = strdup(cmd);
+    int cap = 8, argc = 0;
+    char **argv = (char**) malloc(sizeof(char*) * cap);
+    for (char *tok = strtok(copy, " \t"); tok; tok = strtok(NULL, " \t")) {
+        if (argc + 1 >= cap) {
+            cap *= 2;
+            argv = (char**) realloc(argv, sizeof(char*) * cap);
+        }
+        argv[argc++] = tok;
+    }
+    argv[argc] = NULL;
+    return argv;
+}
+
+/* Lança o comando parado: o filho faz SIGSTOP a si próprio antes do exec */
+static int real_spawn(RealProc *p) {
+    int rc = fork();
+    if (rc < 0) {
+        return -1;
+    } else if (rc == 0) {
+        setpgid(0, 0);
+        raise(SIGSTOP);
+        execvp(p->argv[0], p->argv);
+        fprintf(stderr, "exec de %s falhou: %s\n", p->argv[0], strerror(errno));
+        _exit(127);
+    }
+    setpgid(rc, rc);
+    int status;
+    if (waitpid(rc, &status, WUNTRACED) != rc || !WIFSTOPPED(status)) {
+        kill(rc, SIGKILL);
+        waitpid(rc, &status, 0);
+        return -1;
+    }
+    p->pid = rc;
+    p->pidfd = (int) syscall(SYS_pidfd_open, rc, 0);
+    if (p->pidfd < 0) {
+        kill(rc, SIGKILL);
+        waitpid(rc, &status, 0);
+        return -1;
+    }
+    return 0;
+}
+
+/* Lançamento a meio falhou: mata e recolhe os n primeiros (ainda parados) */
+static void real_abort(RealProc *procs, int n) {
+    for (int i = 0; i < n; ++i) {
+        killpg(procs[i].pid, SIGKILL);
+        waitpid(procs[i].pid, NULL, 0);
+        close(procs[i].pidfd);
+    }
+}
+
+static void arm_quantum(int tfd, double seconds) {
+    struct itimerspec its;
+    memset(&its, 0, sizeof(its));
+    its.it_value.tv_sec = (time_t) seconds;
+    its.it_value.tv_nsec = (long) ((seconds - (time_t) seconds) * 1e9);
+    timerfd_settime(tfd, 0, &its, NULL);
+}
+
+/* Dá o CPU a p até terminar ou esgotar o quantum (quantum <= 0: até terminar).
+ * Devolve 1 se terminou; em *cpu_used o CPU consumido durante o slice. */
+static int real_dispatch(RealProc *p, int tfd, double quantum, double t0, double *cpu_used) {
+    double cpu0 = schedstat_runtime(p->pid);
+    double start = real_now();
+    if (p->first_run < 0) p->first_run = start - t0;
+    if (quantum > 0) arm_quantum(tfd, quantum);
+    killpg(p->pid, SIGCONT);
+
+    struct pollfd pfds[2] = { { p->pidfd, POLLIN, 0 }, { tfd, POLLIN, 0 } };
+    while (poll(pfds, quantum > 0 ? 2 : 1, -1) < 0 && errno == EINTR) { }
+
+    int finished = 0;
+    int status;
+    if (pfds[0].revents) {
+        wait4(p->pid, &status, 0, &p->ru);
+        finished = 1;
+    } else {
+        uint64_t expirations;
+        if (read(tfd, &expirations, sizeof(expirations)) < 0) { /* timer já consumido */ }
+        double cpu1 = schedstat_runtime(p->pid);
+        killpg(p->pid, SIGSTOP);
+        /* pode ter terminado entre o timer e o SIGSTOP */
+        if (wait4(p->pid, &status, WUNTRACED, &p->ru) == p->pid && !WIFSTOPPED(status)) finished = 1;
+        *cpu_used = (cpu0 >= 0 && cpu1 >= 0) ? cpu1 - cpu0 : quantum;
+    }
+    double end = real_now();
+    p->dispatched += end - start;
+    if (finished) {
+        p->done = 1;
+        p->finish = end - t0;
+        close(p->pidfd);
+    }
+    return finished;
+}
+
+static int run_real(const char *alg, char **commands, int n, int cpu) {
+    if (strcmp(alg, "fifo") != 0 && strcmp(alg, "rr") != 0 && strcmp(alg, "mlfq") != 0) {
+        fprintf(stderr, "Modo real suporta fifo | rr | mlfq (sjf precisa da duração dos jobs)\n");
+        return 1;
+    }
+    /* fixa o escalonador (e por herança os filhos) num único CPU */
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    if (sched_setaffinity(0, sizeof(set), &set) != 0) perror("sched_setaffinity");
+
+    RealProc *procs = (RealProc*) calloc(n, sizeof(RealProc));
+    for (int i = 0; i < n; ++i) {
+        RealProc *p = &procs[i];
+        p->argv = split_command(commands[i]);
+        if (!p->argv[0]) {
+            fprintf(stderr, "Comando vazio na posição %d\n", i + 1);
+            real_abort(procs, i);
+            return 1;
+        }
+        char label[64];
+        snprintf(label, sizeof(label), "%d:%s", i + 1, p->argv[0]);
+        memcpy(p->name, label, sizeof(p->name) - 1); /* calloc: já terminado em 0 */
+        p->first_run = -1.0;
+        if (real_spawn(p) != 0) {
+            fprintf(stderr, "Falhou o lançamento de %s\n", commands[i]);
+            real_abort(procs, i);
+            return 1;
+        }
+    }
+    int tfd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+
+    /* filas: RR usa a fila 0; MLFQ usa MLFQ_LEVELS filas; FIFO corre por ordem */
+    int levels = strcmp(alg, "mlfq") == 0 ? MLFQ_LEVELS : 1;
+    int *queues[MLFQ_LEVELS];
+    int qstart[MLFQ_LEVELS], qlen[MLFQ_LEVELS];
+    for (int l = 0; l < levels; ++l) {
+        queues[l] = (int*) malloc(sizeof(int) * n);
+        qstart[l] = qlen[l] = 0;
+    }
+    for (int i = 0; i < n; ++i) queues[0][qlen[0]++] = i;
+
+    double quantum = strcmp(alg, "fifo") == 0 ? 0.0 : QUANTUM;
+    double t0 = real_now();
+    for (;;) {
+        int l = 0;
+        while (l < levels && qlen[l] == 0) l++;
+        if (l == levels) break;
+        int idx = queues[l][qstart[l]];
+        qstart[l] = (qstart[l] + 1) % n;
+        qlen[l]--;
+
+        RealProc *p = &procs[idx];
+        double cpu_used = 0.0;
+        if (real_dispatch(p, tfd, quantum, t0, &cpu_used)) continue;
+        /* MLFQ: como em run_mlfq, desce se usou (quase) todo o quantum */
+        int new_l = mlfq_next_level(l, cpu_used >= REAL_DEMOTE_FRACTION * quantum, levels);
+        p->level = new_l;
+        queues[new_l][(qstart[new_l] + qlen[new_l]) % n] = idx;
+        qlen[new_l]++;
+    }
+    close(tfd);
+
+    Result *res = (Result*) malloc(sizeof(Result) * n);
+    for (int i = 0; i < n; ++i) {
+        RealProc *p = &procs[i];
+        strcpy(res[i].name, p->name);
+        res[i].Elapsed = p->finish;
+        res[i].CPU = tv_seconds(p->ru.ru_utime) + tv_seconds(p->ru.ru_stime);
+        res[i].BLOCKED = p->dispatched - res[i].CPU;
+        if (res[i].BLOCKED < 0.0) res[i].BLOCKED = 0.0;
+        res[i].FirstRun = p->first_run;
+    }
+    print_results(alg, "real", res, n);
+
+    for (int l = 0; l < levels; ++l) free(queues[l]);
+    for (int i = 0; i < n; ++i) {
+        free(procs[i].argv[0]);
+        free(procs[i].argv);
+    }
+    free(procs);
+    free(res);
+    return 0;
+}
+
+/* ------------------- Calibração (processos sintéticos reais) ------------------- */
+
+#define DEADLINE_BANDWIDTH 0.9
+
+#ifndef SCHED_DEADLINE
+#define SCHED_DEADLINE 6
+#endif
+
+/* Classe de escalonamento do kernel usada para correr os processos sintéticos */
+typedef struct {
+    const char *name;
+    int policy;
+    int priority; /* SCHED_RR/SCHED_FIFO */
+} KernelPolicy;
+
+static const KernelPolicy kernel_policies[] = {
+    { "other",    SCHED_OTHER,    0 },
+    { "batch",    SCHED_BATCH,    0 },
+    { "idle",     SCHED_IDLE,     0 },
+    { "fifo",     SCHED_FIFO,     1 },
+    { "rr",       SCHED_RR,       1 },
+    { "deadline", SCHED_DEADLINE, 0 },
+};
+#define N_KERNEL_POLICIES ((int) (sizeof(kernel_policies) / sizeof(kernel_policies[0])))
+
+static const KernelPolicy *find_kernel_policy(const char *name) {
+    for (int i = 0; i < N_KERNEL_POLICIES; ++i) {
+        if (strcmp(name, kernel_policies[i].name) == 0) return &kernel_policies[i];
+    }
+    return NULL;
+}
+
+/* Parâmetros de uma execução sintética */
+typedef struct {
+    const KernelPolicy *kp;
+    const cpu_set_t *cpus; /* ignorado em SCHED_DEADLINE (exige afinidade total) */
+    const int *nice;       /* nice por processo (SCHED_OTHER/BATCH) ou NULL */
+    double scale;          /* segundos reais por segundo simulado */
+    unsigned long long dl_runtime, dl_period; /* SCHED_DEADLINE, em ns */
+} SyntheticRun;
+
+/* Medições escritas por cada filho sintético (MAP_SHARED) */
+typedef struct {
+    double first_run; /* relativo ao arranque comum */
+    double blocked;   /* tempo real desde o início de cada IOEvent até voltar a correr */
+    double run_delay; /* /proc/self/schedstat: tempo à espera na runqueue (s) */
+} SyntheticStats;
+
+static double thread_cpu_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* Queima CPU até o processo ter consumido `target` segundos de CPU */
+static void burn_until(double cpu_start, double target) {
+    volatile unsigned long x = 1;
+    while (thread_cpu_now() - cpu_start < target) {
+        for (int i = 0; i < 1000; ++i) x = x * 6364136223846793005UL + 1;
+    }
+}
+
+/* Corpo do filho: reproduz o Process à escala dada (CPU e IO) */
+static void synthetic_child(const Process *p, double scale, int start_fd, SyntheticStats *st) {
+    char c;
+    while (read(start_fd, &c, 1) < 0 && errno == EINTR) { }
+    if (p->arrival > 0.0) {
+        double a = p->arrival * scale;
+        struct timespec ts = { (time_t) a, (long) ((a - (time_t) a) * 1e9) };
+        while (nanosleep(&ts, &ts) != 0 && errno == EINTR) { }
+    }
+    double start = real_now();
+    double cpu_start = thread_cpu_now();
+    st->first_run = start;
+    double done = 0.0;
+    for (int i = 0; i < p->io_count; ++i) {
+        double when = p->io_events[i].when_cpu;
+        if (when > p->total_cpu_needed) break;
+        burn_until(cpu_start, when * scale);
+        done = when;
+        double s0 = real_now();
+        double d = p->io_events[i].duration * scale;
+        struct timespec ts = { (time_t) d, (long) ((d - (time_t) d) * 1e9) };
+        while (nanosleep(&ts, &ts) != 0 && errno == EINTR) { }
+        st->blocked += real_now() - s0;
+    }
+    if (done < p->total_cpu_needed) burn_until(cpu_start, p->total_cpu_needed * scale);
+    char buf[128];
+    int fd = open("/proc/self/schedstat", O_RDONLY);
+    if (fd >= 0) {
+        ssize_t len = read(fd, buf, sizeof(buf) - 1);
+        if (len > 0) {
+            buf[len] = '\0';
+            char *end;
+            strtoull(buf, &end, 10);
+            st->run_delay = strtoull(end, NULL, 10) / 1e9;
+        }
+        close(fd);
+    }
+    _exit(0);
+}
+
+/* struct sched_attr de sched_setattr(2); a glibc não a exporta */
+typedef struct {
+    uint32_t size;
+    uint32_t sched_policy;
+    uint64_t sched_flags;
+    int32_t sched_nice;
+    uint32_t sched_priority;
+    uint64_t sched_runtime;
+    uint64_t sched_deadline;
+    uint64_t sched_period;
+} SchedAttr;
+
+static int apply_kernel_policy(const SyntheticRun *run, int nice) {
+    SchedAttr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.sched_policy = run->kp->policy;
+    attr.sched_priority = run->kp->priority;
+    if (run->kp->policy == SCHED_OTHER || run->kp->policy == SCHED_BATCH) attr.sched_nice = nice;
+    if (run->kp->policy == SCHED_DEADLINE) {
+        attr.sched_runtime = run->dl_runtime;
+        attr.sched_deadline = run->dl_period;
+        attr.sched_period = run->dl_period;
+    }
+    return (int) syscall(SYS_sched_setattr, 0, &attr, 0);
+}
+
+/* Testa a política num filho descartável; devolve 0 ou o errno */
+static int probe_kernel_policy(const SyntheticRun *run) {
+    int rc = fork();
+    if (rc < 0) return errno;
+    if (rc == 0) _exit(apply_kernel_policy(run, 0) == 0 ? 0 : errno);
+    int status;
+    waitpid(rc, &status, 0);
+    return WIFEXITED(status) ? WEXITSTATUS(status) : EINTR;
+}
+
+/* Corre os n processos em simultâneo sob run->kp, confinados a run->cpus,
+ * e preenche out (em segundos simulados) e, se pedido, run_delay (s simulados).
+ * Devolve -1 se falhou. */
+static int run_synthetic(Process *base, int n, const SyntheticRun *run, Result *out, double *run_delay) {
+    double scale = run->scale;
+    SyntheticStats *stats = (SyntheticStats*) mmap(NULL, sizeof(SyntheticStats) * n, PROT_READ | PROT_WRITE,
+                                                   MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (stats == MAP_FAILED) return -1;
+    memset(stats, 0, sizeof(SyntheticStats) * n);
+
+    int start[2];
+    if (pipe(start) != 0) {
+        munmap(stats, sizeof(SyntheticStats) * n);
+        return -1;
+    }
+    pid_t *pids = (pid_t*) malloc(sizeof(pid_t) * n);
+    fflush(stdout);
+    for (int i = 0; i < n; ++i) {
+        int rc = fork();
+        if (rc < 0) {
+            /* os já lançados ainda esperam pelo pipe: mata-os antes de o fechar */
+            for (int j = 0; j < i; ++j) {
+                kill(pids[j], SIGKILL);
+                waitpid(pids[j], NULL, 0);
+            }
+            close(start[0]);
+            close(start[1]);
+            free(pids);
+            munmap(stats, sizeof(SyntheticStats) * n);
+            return -1;
+        } else if (rc == 0) {
+            close(start[1]);
+            if (run->kp->policy != SCHED_DEADLINE) sched_setaffinity(0, sizeof(cpu_set_t), run->cpus);
+            if (apply_kernel_policy(run, run->nice ? run->nice[i] : 0) != 0) _exit(2);
+            synthetic_child(&base[i], scale, start[0], &stats[i]);
+        }
+        pids[i] = rc;
+    }
+    close(start[0]);
+    double t0 = real_now();
+    close(start[1]); /* EOF: todos arrancam agora */
+
+    int failed = 0;
+    for (int done = 0; done < n; ++done) {
+        int status;
+        struct rusage ru;
+        pid_t pid = wait4(-1, &status, 0, &ru);
+        if (pid < 0) {
+            if (errno == EINTR) { done--; continue; }
+            failed = 1;
+            break;
+        }
+        double end = real_now();
+        int i = 0;
+        while (i < n && pids[i] != pid) i++;
+        if (i == n) { done--; continue; }
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) failed = 1;
+        strcpy(out[i].name, base[i].name);
+        out[i].Elapsed = (end - t0) / scale - base[i].arrival;
+        out[i].CPU = (tv_seconds(ru.ru_utime) + tv_seconds(ru.ru_stime)) / scale;
+        out[i].BLOCKED = stats[i].blocked / scale;
+        out[i].FirstRun = stats[i].first_run > 0 ? (stats[i].first_run - t0) / scale - base[i].arrival : 0.0;
+        if (out[i].FirstRun < 0.0) out[i].FirstRun = 0.0;
+        if (run_delay) run_delay[i] = stats[i].run_delay / scale;
+    }
+    free(pids);
+    munmap(stats, sizeof(SyntheticStats) * n);
+    return failed ? -1 : 0;
+}
+
+static double rel_error(double measured, double predicted) {
+    if (fabs(predicted) < EPS) return fabs(measured) < EPS ? 0.0 : 100.0;
+    return 100.0 * (measured - predicted) / predicted;
+}
+
+static void print_errors(Result *pred, Result *real, int n) {
+    printf("\n=== Erro da simulação (real - simulado) ===\n");
+    printf("%6s | %8s | %8s | %7s | %8s | %8s | %8s\n",
+           "Proc", "Ela.sim", "Ela.real", "err %", "1st.sim", "1st.real", "err abs");
+    printf("--------------------------------------------------------------------\n");
+    double sum_abs = 0.0;
+    for (int i = 0; i < n; ++i) {
+        int j = 0;
+        while (j < n && strcmp(pred[j].name, real[i].name) != 0) j++;
+        if (j == n) continue;
+        double e = rel_error(real[i].Elapsed, pred[j].Elapsed);
+        sum_abs += fabs(e);
+        printf("%6s | %8.3f | %8.3f | %+7.1f | %8.3f | %8.3f | %+8.3f\n",
+               real[i].name, pred[j].Elapsed, real[i].Elapsed, e,
+               pred[j].FirstRun, real[i].FirstRun, real[i].FirstRun - pred[j].FirstRun);
+    }
+    printf("--------------------------------------------------------------------\n");
+    printf("erro médio absoluto do Elapsed: %.1f %%\n", n > 0 ? sum_abs / n : 0.0);
+}
+
+static int run_calibrate(const char *alg, const char *scenario, const char *policy, double scale, int cpu) {
+    if (!valid_algorithm(alg)) {
+        fprintf(stderr, "Algoritmo inválido: %s\n", alg);
+        return 1;
+    }
+    const KernelPolicy *kp = find_kernel_policy(policy);
+    if (!kp || (kp->policy != SCHED_OTHER && kp->policy != SCHED_RR)) {
+        fprintf(stderr, "Política inválida: %s (other | rr)\n", policy);
+        return 1;
+    }
+    int n;
+    Process *base = load_scenario(scenario, &n);
+    if (!base) {
+        fprintf(stderr, "Cenário inválido: %s\n", scenario);
+        return 1;
+    }
+
+    /* SCHED_RR exige privilégios: se não houver, recai em SCHED_OTHER */
+    struct sched_param sp = { .sched_priority = kp->priority };
+    if (kp->policy != SCHED_OTHER) {
+        if (sched_setscheduler(0, kp->policy, &sp) != 0) {
+            fprintf(stderr, "Sem privilégios para %s (%s); a usar other\n", kp->name, strerror(errno));
+            kp = find_kernel_policy("other");
+        } else {
+            struct timespec slice;
+            if (sched_rr_get_interval(0, &slice) == 0 && kp->policy == SCHED_RR)
+                printf("timeslice SCHED_RR do kernel: %.1f ms (quantum simulado: %.1f ms)\n",
+                       slice.tv_sec * 1e3 + slice.tv_nsec / 1e6, QUANTUM * scale * 1e3);
+            sp.sched_priority = 0;
+            sched_setscheduler(0, SCHED_OTHER, &sp);
+        }
+    }
+
+    int pred_n = 0;
+    Result *pred = run_algorithm(alg, base, n, &pred_n);
+    Result *real = (Result*) calloc(n, sizeof(Result));
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    SyntheticRun run = { kp, &set, NULL, scale, 0, 0 };
+    if (run_synthetic(base, n, &run, real, NULL) != 0) {
+        fprintf(stderr, "Execução sintética falhou\n");
+        return 1;
+    }
+    char label[256];
+    snprintf(label, sizeof(label), "%s, kernel %s, escala %g", scenario, kp->name, scale);
+    print_results(alg, label, pred, pred_n);
+    print_results("medido", label, real, n);
+    print_errors(pred, real, n);
+
+    free(pred);
+    free(real);
+    free_processes(base, n);
+    return 0;
+}
+
+/* ------------------- Experiências com o escalonador do host ------------------- */
+
+/* Lê uma lista "0,2-3" para um cpu_set_t; devolve -1 se inválida */
+static int parse_cpu_list(const char *list, cpu_set_t *set) {
+    CPU_ZERO(set);
+    char *copy = strdup(list);
+    int count = 0;
+    for (char *tok = strtok(copy, ","); tok; tok = strtok(NULL, ",")) {
+        int a, b;
+        if (sscanf(tok, "%d-%d", &a, &b) == 2) {
+            for (int c = a; c <= b && c < CPU_SETSIZE; ++c) { CPU_SET(c, set); count++; }
+        } else if (sscanf(tok, "%d", &a) == 1 && a >= 0 && a < CPU_SETSIZE) {
+            CPU_SET(a, set);
+            count++;
+        }
+    }
+    free(copy);
+    return count > 0 ? 0 : -1;
+}
+
+static void print_run_delay(Result *res, double *run_delay, int n) {
+    printf("%6s | %8s\n", "Proc", "RunDelay");
+    for (int i = 0; i < n; ++i) printf("%6s | %8.3f\n", res[i].name, run_delay[i]);
+    printf("--------------------------------------------------------------\n");
+}
+
+static int run_host(const char *scenario, const char *policies, const char *cpus, const char *nices, double scale) {
+    int n;
+    Process *base = load_scenario(scenario, &n);
+    if (!base) {
+        fprintf(stderr, "Cenário inválido: %s\n", scenario);
+        return 1;
+    }
+    cpu_set_t set;
+    if (parse_cpu_list(cpus, &set) != 0) {
+        fprintf(stderr, "Lista de CPUs inválida: %s\n", cpus);
+        return 1;
+    }
+    /* nice por processo: a lista repete-se se for mais curta que o cenário */
+    int *nice = (int*) calloc(n, sizeof(int));
+    if (nices) {
+        int values[64], count = 0;
+        char *copy = strdup(nices);
+        for (char *tok = strtok(copy, ","); tok && count < 64; tok = strtok(NULL, ",")) values[count++] = atoi(tok);
+        free(copy);
+        for (int i = 0; i < n && count > 0; ++i) nice[i] = values[i % count];
+    }
+
+    /* previsões do simulador para comparação */
+    const char *sims[] = { "rr", "mlfq" };
+    char label[256];
+    for (int k = 0; k < 2; ++k) {
+        int count = 0;
+        Result *pred = run_algorithm(sims[k], base, n, &count);
+        snprintf(label, sizeof(label), "%s, simulado", scenario);
+        print_results(sims[k], label, pred, count);
+        free(pred);
+    }
+
+    Result *res = (Result*) calloc(n, sizeof(Result));
+    double *run_delay = (double*) calloc(n, sizeof(double));
+    char *copy = strdup(policies);
+    for (char *name = strtok(copy, ","); name; name = strtok(NULL, ",")) {
+        const KernelPolicy *kp = find_kernel_policy(name);
+        if (!kp) {
+            fprintf(stderr, "Política desconhecida: %s\n", name);
+            continue;
+        }
+        /* SCHED_DEADLINE: um quantum por período; a soma das larguras de banda
+         * fica em DEADLINE_BANDWIDTH para passar o controlo de admissão */
+        unsigned long long runtime = (unsigned long long) (QUANTUM * scale * 1e9);
+        SyntheticRun run = { kp, &set, nice, scale, runtime, (unsigned long long) (runtime * n / DEADLINE_BANDWIDTH) };
+        int err = probe_kernel_policy(&run);
+        if (err != 0) {
+            printf("\npolítica %s ignorada: %s\n", kp->name, strerror(err));
+            continue;
+        }
+        memset(res, 0, sizeof(Result) * n);
+        if (run_synthetic(base, n, &run, res, run_delay) != 0) {
+            fprintf(stderr, "Execução sob %s falhou\n", kp->name);
+            continue;
+        }
+        snprintf(label, sizeof(label), "%s, CPUs %s%s, escala %g", scenario, cpus,
+                 kp->policy == SCHED_DEADLINE ? " (ignorados)" : "", scale);
+        print_results(kp->name, label, res, n);
+        print_run_delay(res, run_delay, n);
+    }
+    free(copy);
+    free(res);
+    free(run_delay);
+    free(nice);
+    free_processes(base, n);
+    return 0;
+}
+
+/* ------------------- Medição de interferência (STREAM triad) ------------------- */
+
+typedef struct {
+    int cpu;
+    size_t len;
+    int reps;
+    pthread_barrier_t *barrier;
+    double bandwidth; /* bytes/s desta thread */
+} StreamArg;
+
+static void *stream_worker(void *arg) {
+    StreamArg *sa = (StreamArg*) arg;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(sa->cpu, &set);
+    sched_setaffinity(0, sizeof(set), &set);
+    double *a = (double*) malloc(sizeof(double) * sa->len);
+    double *b = (double*) malloc(sizeof(double) * sa->len);
+    double *c = (double*) malloc(sizeof(double) * sa->len);
+    for (size_t i = 0; i < sa->len; ++i) { a[i] = 0.0; b[i] = 1.0; c[i] = 2.0; }
+    pthread_barrier_wait(sa->barrier);
+    double t0 = real_now();
+    for (int r = 0; r < sa->reps; ++r) {
+        for (size_t i = 0; i < sa->len; ++i) a[i] = b[i] + 3.0 * c[i];
+        __asm__ volatile("" : : "r"(a) : "memory");
+    }
+    sa->bandwidth = 3.0 * sizeof(double) * sa->len * sa->reps / (real_now() - t0);
+    free(a);
+    free(b);
+    free(c);
+    return NULL;
+}
+
+/* Corre a triad em k threads (CPUs distintos) e devolve a largura média por thread */
+static double stream_run(const int *cpus, int k, size_t len, int reps) {
+    pthread_t threads[MAX_WORKERS];
+    StreamArg args[MAX_WORKERS];
+    pthread_barrier_t barrier;
+    pthread_barrier_init(&barrier, NULL, k);
+    for (int i = 0; i < k; ++i) {
+        args[i] = (StreamArg) { cpus[i], len, reps, &barrier, 0.0 };
+        pthread_create(&threads[i], NULL, stream_worker, &args[i]);
+    }
+    double sum = 0.0;
+    for (int i = 0; i < k; ++i) {
+        pthread_join(threads[i], NULL);
+        sum += args[i].bandwidth;
+    }
+    pthread_barrier_destroy(&barrier);
+    return sum / k;
+}
+
+/* Ajusta beta em abrandamento(k) = bw(1)/bw(k) = 1 + beta * (k - 1)
+ * (STREAM tem mem_intensity = 1) por mínimos quadrados na origem */
+static int run_stream(int max_threads, int mb, const char *out_path) {
+    cpu_set_t allowed;
+    sched_getaffinity(0, sizeof(allowed), &allowed);
+    int cpus[MAX_WORKERS], ncpu = 0;
+    for (int c = 0; c < CPU_SETSIZE && ncpu < MAX_WORKERS; ++c) if (CPU_ISSET(c, &allowed)) cpus[ncpu++] = c;
+    if (max_threads > ncpu) max_threads = ncpu;
+    size_t len = ((size_t) mb << 20) / (3 * sizeof(double));
+    int reps = 10;
+
+    printf("triad: %d MB por thread, %d repetições\n", mb, reps);
+    printf("%7s | %12s | %11s\n", "Threads", "GB/s/thread", "Abrandam.");
+    printf("--------------------------------------------------\n");
+    double bw1 = 0.0, sxy = 0.0, sxx = 0.0;
+    double slowdown[MAX_WORKERS + 1];
+    for (int k = 1; k <= max_threads; ++k) {
+        double bw = stream_run(cpus, k, len, reps);
+        if (k == 1) bw1 = bw;
+        slowdown[k] = bw1 / bw;
+        sxy += (slowdown[k] - 1.0) * (k - 1);
+        sxx += (double) (k - 1) * (k - 1);
+        printf("%7d | %12.2f | %11.3f\n", k, bw / 1e9, slowdown[k]);
+    }
+    double beta = sxx > 0.0 ? sxy / sxx : 0.0;
+    if (beta < 0.0) beta = 0.0;
+    printf("--------------------------------------------------\n");
+    if (max_threads < 2) printf("só há 1 CPU disponível: sem co-runners, beta = 0\n");
+    for (int k = 2; k <= max_threads; ++k)
+        printf("%7d | modelo 1 + beta*(k-1) = %.3f (medido %.3f)\n", k, 1.0 + beta * (k - 1), slowdown[k]);
+    printf("interference=%.4f  ->  ./simulador <alg> <cen> --cpus K -i %.4f\n", beta, beta);
+    if (out_path) {
+        FILE *f = fopen(out_path, "w");
+        if (!f) {
+            perror(out_path);
+            return 1;
+        }
+        fprintf(f, "interference=%.4f\n", beta);
+        fclose(f);
+    }
+    return 0;
+}
+
+/* ------------------- Runtime M:N de green threads ------------------- */
+
+typedef enum { GREEN_READY, GREEN_PARKED, GREEN_DONE } GreenState;
+
+typedef struct {
+    ucontext_t ctx;
+    ucontext_t *sched_ctx;  /* contexto do worker que a está a correr */
+    char *stack;
+    Process *proc;
+    GreenState state;
+    int level;
+    int used_full;          /* esgotou o quantum no último slice */
+    double quantum_end;     /* tempo real; <= 0 = sem quantum */
+    double wake_at;         /* > 0: a tarefa pediu para estacionar até lá */
+    double slice_cpu0;      /* CPU da thread no início do slice */
+    double cpu_used;        /* CPU real consumido (s) */
+    double blocked;         /* tempo real estacionado em IO (s) */
+    double first_run;
+    double finish;
+} GreenTask;
+
+/* Fila de prontos com as regras de escalonamento do simulador */
+typedef struct {
+    const char *alg;
+    int levels;
+    int *q[MLFQ_LEVELS];
+    int qstart[MLFQ_LEVELS];
+    int qlen[MLFQ_LEVELS];
+    int cap;
+} ReadyQueue;
+
+typedef struct {
+    GreenTask *tasks;
+    int n;
+    ReadyQueue rq;
+    int done;
+    double scale;
+    double t0;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+} GreenRuntime;
+
+static GreenRuntime green_rt;
+
+static void rq_init(ReadyQueue *rq, const char *alg, int cap) {
+    rq->alg = alg;
+    rq->levels = strcmp(alg, "mlfq") == 0 ? MLFQ_LEVELS : 1;
+    rq->cap = cap;
+    for (int l = 0; l < rq->levels; ++l) {
+        rq->q[l] = (int*) malloc(sizeof(int) * cap);
+        rq->qstart[l] = rq->qlen[l] = 0;
+    }
+}
+
+static void rq_free(ReadyQueue *rq) {
+    for (int l = 0; l < rq->levels; ++l) free(rq->q[l]);
+}
+
+static void rq_push(ReadyQueue *rq, int level, int idx) {
+    rq->q[level][(rq->qstart[level] + rq->qlen[level]) % rq->cap] = idx;
+    rq->qlen[level]++;
+}
+
+/* Retira o próximo: nível mais alto não vazio; em sjf o de menor total_cpu_needed */
+static int rq_pop(ReadyQueue *rq, GreenTask *tasks) {
+    for (int l = 0; l < rq->levels; ++l) {
+        if (rq->qlen[l] == 0) continue;
+        int pick = 0;
+        if (strcmp(rq->alg, "sjf") == 0) {
+            for (int k = 1; k < rq->qlen[l]; ++k) {
+                int a = rq->q[l][(rq->qstart[l] + k) % rq->cap];
+                int b = rq->q[l][(rq->qstart[l] + pick) % rq->cap];
+                if (tasks[a].proc->total_cpu_needed < tasks[b].proc->total_cpu_needed) pick = k;
+            }
+        }
+        int idx = rq->q[l][(rq->qstart[l] + pick) % rq->cap];
+        /* remove mantendo a ordem dos restantes */
+        for (int k = pick; k > 0; --k)
+            rq->q[l][(rq->qstart[l] + k) % rq->cap] = rq->q[l][(rq->qstart[l] + k - 1) % rq->cap];
+        rq->qstart[l] = (rq->qstart[l] + 1) % rq->cap;
+        rq->qlen[l]--;
+        tasks[idx].level = l;
+        return idx;
+    }
+    return -1;
+}
+
+static int green_preemptive(const char *alg) {
+    return strcmp(alg, "rr") == 0 || strcmp(alg, "mlfq") == 0;
+}
+
+/* Devolve o controlo ao worker; regressa quando a tarefa for retomada
+ * (possivelmente noutra thread) */
+static void green_switch_out(GreenTask *t) {
+    t->cpu_used += thread_cpu_now() - t->slice_cpu0;
+    swapcontext(&t->ctx, t->sched_ctx);
+    t->slice_cpu0 = thread_cpu_now();
+}
+
+/* Queima CPU real até a tarefa ter consumido `target` segundos,
+ * cedendo o worker sempre que o quantum termina */
+static void green_burn(GreenTask *t, double target) {
+    volatile unsigned long x = 1;
+    while (t->cpu_used + (thread_cpu_now() - t->slice_cpu0) < target) {
+        for (int i = 0; i < 1000; ++i) x = x * 6364136223846793005UL + 1;
+        if (t->quantum_end > 0 && real_now() >= t->quantum_end) {
+            t->used_full = 1;
+            green_switch_out(t);
+        }
+    }
+}
+
+/* IO não bloqueante: a tarefa só regista o pedido (wake_at) e cede; é o
+ * worker que a passa a GREEN_PARKED sob o lock, depois de o contexto estar
+ * guardado, para nenhum outro worker a poder retomar antes disso */
+static void green_park(GreenTask *t, double seconds) {
+    double start = real_now();
+    t->wake_at = start + seconds;
+    t->used_full = 0;
+    green_switch_out(t);
+    t->blocked += real_now() - start;
+}
+
+static void green_body(int idx) {
+    GreenTask *t = &green_rt.tasks[idx];
+    Process *p = t->proc;
+    double scale = green_rt.scale;
+    for (int i = 0; i < p->io_count; ++i) {
+        if (p->io_events[i].when_cpu > p->total_cpu_needed) break;
+        green_burn(t, p->io_events[i].when_cpu * scale);
+        green_park(t, p->io_events[i].duration * scale);
+    }
+    green_burn(t, p->total_cpu_needed * scale);
+    t->state = GREEN_DONE;
+    t->finish = real_now() - green_rt.t0;
+    t->cpu_used += thread_cpu_now() - t->slice_cpu0;
+    setcontext(t->sched_ctx); /* nunca regressa */
+}
+
+static void *green_worker(void *arg) {
+    (void) arg;
+    GreenRuntime *rt = &green_rt;
+    ucontext_t my_ctx;
+    double quantum = green_preemptive(rt->rq.alg) ? QUANTUM * rt->scale : 0.0;
+
+    pthread_mutex_lock(&rt->lock);
+    while (rt->done < rt->n) {
+        /* acorda tarefas estacionadas cujo IO terminou */
+        double now = real_now();
+        double next_wake = 0.0;
+        for (int i = 0; i < rt->n; ++i) {
+            GreenTask *t = &rt->tasks[i];
+            if (t->state != GREEN_PARKED) continue;
+            if (t->wake_at <= now) {
+                t->state = GREEN_READY;
+                t->wake_at = 0.0;
+                rq_push(&rt->rq, t->level, i);
+            } else if (next_wake == 0.0 || t->wake_at < next_wake) {
+                next_wake = t->wake_at;
+            }
+        }
+        int idx = rq_pop(&rt->rq, rt->tasks);
+        if (idx < 0) {
+            struct timespec until;
+            double w = next_wake > 0.0 ? next_wake : now + 0.001;
+            until.tv_sec = (time_t) w;
+            until.tv_nsec = (long) ((w - (time_t) w) * 1e9);
+            pthread_cond_timedwait(&rt->cond, &rt->lock, &until);
+            continue;
+        }
+        pthread_mutex_unlock(&rt->lock);
+
+        GreenTask *t = &rt->tasks[idx];
+        double start = real_now();
+        if (t->first_run < 0) t->first_run = start - rt->t0;
+        t->quantum_end = quantum > 0 ? start + quantum : 0.0;
+        t->used_full = 0;
+        t->sched_ctx = &my_ctx;
+        t->slice_cpu0 = thread_cpu_now();
+        swapcontext(&my_ctx, &t->ctx);
+
+        pthread_mutex_lock(&rt->lock);
+        if (t->state == GREEN_DONE) {
+            rt->done++;
+        } else if (t->wake_at > 0.0) {
+            t->state = GREEN_PARKED; /* fica fora da fila até ao wake_at */
+        } else {
+            rq_push(&rt->rq, mlfq_next_level(t->level, t->used_full, rt->rq.levels), idx);
+        }
+        pthread_cond_broadcast(&rt->cond);
+    }
+    pthread_mutex_unlock(&rt->lock);
+    return NULL;
+}
+
+static void green_task_init(GreenTask *t, int idx) {
+    t->stack = (char*) malloc(GREEN_STACK);
+    getcontext(&t->ctx);
+    t->ctx.uc_stack.ss_sp = t->stack;
+    t->ctx.uc_stack.ss_size = GREEN_STACK;
+    t->ctx.uc_link = NULL;
+    makecontext(&t->ctx, (void (*)(void)) green_body, 1, idx);
+}
+
+static int run_green(const char *alg, int scenario, int workers, double scale) {
+    if (!valid_algorithm(alg)) {
+        fprintf(stderr, "Algoritmo inválido: %s\n", alg);
+        return 1;
+    }
+    int n;
+    Process *base = make_scenario(scenario, &n);
+    if (!base) {
+        fprintf(stderr, "Cenário inválido: %d\n", scenario);
+        return 1;
+    }
+    if (workers < 1) workers = 1;
+    if (workers > GREEN_MAX_WORKERS) workers = GREEN_MAX_WORKERS;
+
+    GreenRuntime *rt = &green_rt;
+    rt->tasks = (GreenTask*) calloc(n, sizeof(GreenTask));
+    rt->n = n;
+    rt->done = 0;
+    rt->scale = scale;
+    rq_init(&rt->rq, alg, n);
+    pthread_mutex_init(&rt->lock, NULL);
+    /* os prazos do timedwait vêm de real_now(), que é CLOCK_MONOTONIC */
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&rt->cond, &attr);
+    pthread_condattr_destroy(&attr);
+
+    /* ordem inicial como nos run_*: sjf ordena ao retirar, os outros por chegada */
+    for (int i = 0; i < n; ++i) {
+        GreenTask *t = &rt->tasks[i];
+        t->proc = &base[i];
+        t->state = GREEN_READY;
+        t->first_run = -1.0;
+        green_task_init(t, i);
+        rq_push(&rt->rq, 0, i);
+    }
+
+    pthread_t threads[GREEN_MAX_WORKERS];
+    rt->t0 = real_now();
+    for (int w = 0; w < workers; ++w) pthread_create(&threads[w], NULL, green_worker, NULL);
+    for (int w = 0; w < workers; ++w) pthread_join(threads[w], NULL);
+
+    Result *res = (Result*) malloc(sizeof(Result) * n);
+    for (int i = 0; i < n; ++i) {
+        GreenTask *t = &rt->tasks[i];
+        strcpy(res[i].name, base[i].name);
+        res[i].Elapsed = t->finish / scale;
+        res[i].CPU = t->cpu_used / scale;
+        res[i].BLOCKED = t->blocked / scale;
+        res[i].FirstRun = t->first_run / scale;
+        free(t->stack);
+    }
+    char label[64];
+    snprintf(label, sizeof(label), "%d, green %d workers, escala %g", scenario, workers, scale);
+    print_results(alg, label, res, n);
+
+    free(res);
+    rq_free(&rt->rq);
+    free(rt->tasks);
+    pthread_mutex_destroy(&rt->lock);
+    pthread_cond_destroy(&rt->cond);
+    free_processes(base, n);
+    return 0;
+}
+
+/* ---- benchmark de trocas de contexto: corrotinas vs pthreads ---- */
+
+static ucontext_t bench_main_ctx, bench_co_ctx;
+static long bench_rounds;
+
+static void bench_co_body(void) {
+    for (;;) swapcontext(&bench_co_ctx, &bench_main_ctx);
+}
+
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    int turn;
+} PingPong;
+
+static void *bench_pong(void *arg) {
+    PingPong *pp = (PingPong*) arg;
+    pthread_mutex_lock(&pp->lock);
+    for (long i = 0; i < bench_rounds; ++i) {
+        while (pp->turn != 1) pthread_cond_wait(&pp->cond, &pp->lock);
+        pp->turn = 0;
+        pthread_cond_signal(&pp->cond);
+    }
+    pthread_mutex_unlock(&pp->lock);
+    return NULL;
+}
+
+static int run_green_bench(long rounds) {
+    if (rounds < 1) rounds = 1;
+    bench_rounds = rounds;
+
+    char *stack = (char*) malloc(GREEN_STACK);
+    getcontext(&bench_co_ctx);
+    bench_co_ctx.uc_stack.ss_sp = stack;
+    bench_co_ctx.uc_stack.ss_size = GREEN_STACK;
+    bench_co_ctx.uc_link = NULL;
+    makecontext(&bench_co_ctx, bench_co_body, 0);
+    double t0 = real_now();
+    for (long i = 0; i < rounds; ++i) swapcontext(&bench_main_ctx, &bench_co_ctx);
+    double co = (real_now() - t0) / (2.0 * rounds);
+    free(stack);
+
+    PingPong pp = { PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, 0 };
+    pthread_t th;
+    pthread_create(&th, NULL, bench_pong, &pp);
+    t0 = real_now();
+    pthread_mutex_lock(&pp.lock);
+    for (long i = 0; i < rounds; ++i) {
+        pp.turn = 1;
+        pthread_cond_signal(&pp.cond);
+        while (pp.turn != 0) pthread_cond_wait(&pp.cond, &pp.lock);
+    }
+    pthread_mutex_unlock(&pp.lock);
+    double th_cost = (real_now() - t0) / (2.0 * rounds);
+    pthread_join(th, NULL);
+
+    printf("\n=== Custo de uma troca de contexto (%ld idas e voltas) ===\n", rounds);
+    printf("%-22s | %10s\n", "Mecanismo", "ns/troca");
+    printf("-------------------------------------\n");
+    printf("%-22s | %10.1f\n", "corrotina (ucontext)", co * 1e9);
+    printf("%-22s | %10.1f\n", "pthread (mutex+cond)", th_cost * 1e9);
+    printf("-------------------------------------\n");
+    return 0;
+}
+
+/* ------------------- Main / CLI ------------------- */
+
+static void usage(const char *prog) {
+    printf("Uso: %s <algorithm> <scenario> [repeat] [-j workers] [-x custo]\n", prog);
+    printf("       [--cpus K] [-i beta] [--epoch t] [--place rr|least|random] [--threads T]\n");
+    printf(" algorithm = fifo | sjf | rr | mlfq\n");
+    printf(" scenario = 1 | 2 | 3 | 4 | ficheiro\n");
+    printf(" repeat = (opcional) número de execuções para média (default 3)\n");
+    printf(" workers = (opcional) repetições em processos filho isolados (default 1)\n");
+    printf("Uso: %s real <fifo|rr|mlfq> [-c cpu] \"<comando>\" ...\n", prog);
+    printf("Uso: %s calibrate <algorithm> <scenario> [-p other|rr] [-s escala] [-c cpu]\n", prog);
+    printf("Uso: %s host <scenario> [-p políticas] [-c cpus] [-n nices] [-s escala]\n", prog);
+    printf("Uso: %s stream [-t threads] [-m MB] [-o ficheiro]\n", prog);
+    printf("Uso: %s cluster <algorithm> <scenario|gen> [--hosts H] [--dispatch random|rr|jsq|po2|least]\n", prog);
+    printf("       [--jobs N] [--load rho] [--mean S] [--fanout k] [--hedge d] [--seed s] [-x custo]\n");
+    printf("       [--autoscale util|queue[,...]] [--target a,...] [--min m] [--period p]\n");
+    printf("       [--delay d,...] [--cooldown c,...] [--slo s] [--threads T]\n");
+    printf("Uso: %s tune <scenario|gen> [--jobs N] [--load rho] [--mean S] [--seed s] [-w peso]\n", prog);
+    printf("       [--eta k] [--threads T] [-x custo]\n");
+    printf("Uso: %s fast fifo|sjf [--jobs N] [--load rho] [--mean S] [--seed s] [--threads T] [--check] [-x custo]\n", prog);
+    printf("Uso: %s analytic <scenario|gen> [--cpus K] [--jobs N] [--load rho] [--mean S] [--seed s]\n", prog);
+    printf("       [--validate n] [--epoch t] [-x custo]\n");
+    printf("Uso: %s adversary <algorithm> [--metric starvation|p99|slowdown] [--procs n] [--budget B]\n", prog);
+    printf("       [--pop P] [--gens G] [--top k] [--threads T] [--seed s] [-o prefixo] [-x custo]\n");
+    printf("Uso: %s green <algorithm> <scenario> [-w workers] [-s escala] | green bench [-n trocas]\n", prog);
+}
+
+int main(int argc, char **argv) {
+    if (argc >= 2 && strcmp(argv[1], "real") == 0) {
+        int cpu = 0;
+        int first = 3;
+        if (argc >= 5 && strcmp(argv[3], "-c") == 0) {
+            cpu = atoi(argv[4]);
+            first = 5;
+        }
+        if (argc <= first) {
+            usage(argv[0]);
+            return 1;
+        }
+        return run_real(argv[2], &argv[first], argc - first, cpu);
+    }
+    if (argc >= 2 && strcmp(argv[1], "calibrate") == 0) {
+        if (argc < 4) {
+            usage(argv[0]);
+            return 1;
+        }
+        const char *policy = "other";
+        double scale = 0.01;
+        int cpu = 0;
+        for (int i = 4; i + 1 < argc; i += 2) {
+            if (strcmp(argv[i], "-p") == 0) policy = argv[i + 1];
+            else if (strcmp(argv[i], "-s") == 0) scale = atof(argv[i + 1]);
+            else if (strcmp(argv[i], "-c") == 0) cpu = atoi(argv[i + 1]);
+        }
+        if (scale <= 0.0) scale = 0.01;
+        return run_calibrate(argv[2], argv[3], policy, scale, cpu);
+    }
+    if (argc >= 3 && strcmp(argv[1], "host") == 0) {
+        const char *policies = "other,batch,idle,fifo,rr,deadline";
+        const char *cpus = "0";
+        const char *nices = NULL;
+        double scale = 0.01;
+        for (int i = 3; i + 1 < argc; i += 2) {
+            if (strcmp(argv[i], "-p") == 0) policies = argv[i + 1];
+            else if (strcmp(argv[i], "-c") == 0) cpus = argv[i + 1];
+            else if (strcmp(argv[i], "-n") == 0) nices = argv[i + 1];
+            else if (strcmp(argv[i], "-s") == 0) scale = atof(argv[i + 1]);
+        }
+        if (scale <= 0.0) scale = 0.01;
+        return run_host(argv[2], policies, cpus, nices, scale);
+    }
+    if (argc >= 2 && strcmp(argv[1], "stream") == 0) {
+        int threads = MAX_WORKERS, mb = 64;
+        const char *out_path = NULL;
+        for (int i = 2; i + 1 < argc; i += 2) {
+            if (strcmp(argv[i], "-t") == 0) threads = atoi(argv[i + 1]);
+            else if (strcmp(argv[i], "-m") == 0) mb = atoi(argv[i + 1]);
+            else if (strcmp(argv[i], "-o") == 0) out_path = argv[i + 1];
+        }
+        if (threads < 1) threads = 1;
+        if (threads > MAX_WORKERS) threads = MAX_WORKERS;
+        if (mb < 1) mb = 1;
+        return run_stream(threads, mb, out_path);
+    }
+    if (argc >= 4 && strcmp(argv[1], "cluster") == 0) {
+        const char *alg = argv[2];
+        ClusterConfig cfg = { 1000, DISPATCH_PO2, 42, -1.0, NULL, 0.0, 1, 10.0, 30.0, 60.0, 0.0 };
+        int jobs = 100000, fanout = 1, threads = (int) sysconf(_SC_NPROCESSORS_ONLN);
+        double load = 0.8, mean = 1.0;
+        const char *ctl_list = NULL;
+        double targets[64], delays[64], cooldowns[64];
+        int n_targets = 0, n_delays = 1, n_cooldowns = 1;
+        delays[0] = cfg.delay;
+        cooldowns[0] = cfg.cooldown;
+        for (int i = 4; i + 1 < argc; i += 2) {
+            if (strcmp(argv[i], "--hosts") == 0) cfg.hosts = atoi(argv[i + 1]);
+            else if (strcmp(argv[i], "--jobs") == 0) jobs = atoi(argv[i + 1]);
+            else if (strcmp(argv[i], "--load") == 0) load = atof(argv[i + 1]);
+            else if (strcmp(argv[i], "--mean") == 0) mean = atof(argv[i + 1]);
+            else if (strcmp(argv[i], "--seed") == 0) cfg.seed = strtoull(argv[i + 1], NULL, 10);
+            else if (strcmp(argv[i], "--fanout") == 0) fanout = atoi(argv[i + 1]);
+            else if (strcmp(argv[i], "--hedge") == 0) cfg.hedge = atof(argv[i + 1]);
+            else if (strcmp(argv[i], "--autoscale") == 0) ctl_list = argv[i + 1];
+            else if ((strcmp(argv[i], "--target") == 0 && (n_targets = parse_list(argv[i + 1], targets, 64)) == 0) ||
+                     (strcmp(argv[i], "--delay") == 0 && (n_delays = parse_list(argv[i + 1], delays, 64)) == 0) ||
+                     (strcmp(argv[i], "--cooldown") == 0 && (n_cooldowns = parse_list(argv[i + 1], cooldowns, 64)) == 0)) {
+                fprintf(stderr, "Lista inválida para %s: %s\n", argv[i], argv[i + 1]);
+                return 1;
+            }
+            else if (strcmp(argv[i], "--min") == 0) cfg.min_hosts = atoi(argv[i + 1]);
+            else if (strcmp(argv[i], "--period") == 0) cfg.period = atof(argv[i + 1]);
+            else if (strcmp(argv[i], "--slo") == 0) cfg.slo = atof(argv[i + 1]);
+            else if (strcmp(argv[i], "--threads") == 0) threads = atoi(argv[i + 1]);
+            else if (strcmp(argv[i], "-x") == 0 && load_param(argv[i + 1], "switch_cost", &switch_cost) != 0) {
+                fprintf(stderr, "Custo de troca inválido: %s\n", argv[i + 1]);
+                return 1;
+            } else if (strcmp(argv[i], "--dispatch") == 0) {
+                int found = -1;
+                for (int d = 0; d < N_DISPATCH; ++d) if (strcmp(argv[i + 1], dispatch_names[d]) == 0) found = d;
+                if (found < 0) {
+                    fprintf(stderr, "Dispatcher inválido: %s (random | rr | jsq | po2 | least)\n", argv[i + 1]);
+                    return 1;
+                }
+                cfg.policy = (DispatchPolicy) found;
+            }
+        }
+        if (!valid_algorithm(alg)) {
+            fprintf(stderr, "Algoritmo inválido: %s\n", alg);
+            return 1;
+        }
+        if (cfg.hosts < 1) cfg.hosts = 1;
+        if (jobs < 1) jobs = 1;
+        if (mean <= 0.0) mean = 1.0;
+        if (load <= 0.0) load = 0.8;
+        if (fanout < 1) fanout = 1;
+        if (threads < 1) threads = 1;
+
+        /* combinações controlador x alvo x arranque x cooldown */
+        ClusterConfig *cfgs = NULL;
+        int count = 0;
+        if (ctl_list) {
+            if (cfg.period <= 0.0) {
+                fprintf(stderr, "Parâmetros de autoscaling inválidos\n");
+                return 1;
+            }
+            if (cfg.min_hosts < 1) cfg.min_hosts = 1;
+            if (cfg.min_hosts > cfg.hosts) cfg.min_hosts = cfg.hosts;
+            if (cfg.slo <= 0.0) cfg.slo = 10.0 * mean;
+            char names[256];
+            snprintf(names, sizeof(names), "%s", ctl_list);
+            int n_ctl = 1;
+            for (const char *c = ctl_list; *c; ++c) n_ctl += *c == ',';
+            cfgs = (ClusterConfig*) malloc(sizeof(ClusterConfig) * n_ctl * (n_targets > 0 ? n_targets : 1) *
+                                           n_delays * n_cooldowns);
+            for (char *name = strtok(names, ","); name; name = strtok(NULL, ",")) {
+                const ScaleController *ctl = NULL;
+                for (int c = 0; c < N_CONTROLLERS; ++c) if (strcmp(name, scale_controllers[c].name) == 0) ctl = &scale_controllers[c];
+                if (!ctl) {
+                    fprintf(stderr, "Controlador inválido: %s (util | queue)\n", name);
+                    free(cfgs);
+                    return 1;
+                }
+                int nt = n_targets > 0 ? n_targets : 1;
+                for (int a = 0; a < nt; ++a) {
+                    for (int d = 0; d < n_delays; ++d) {
+                        for (int c = 0; c < n_cooldowns; ++c) {
+                            ClusterConfig *k = &cfgs[count++];
+                            *k = cfg;
+                            k->ctl = ctl;
+                            k->target = n_targets > 0 ? targets[a] : ctl->default_target;
+                            k->delay = delays[d];
+                            k->cooldown = cooldowns[c];
+                        }
+                    }
+                }
+            }
+        }
+
+        int n;
+        Process *work;
+        if (strcmp(argv[3], "gen") == 0) {
+            n = jobs;
+            work = generate_workload(n, load * cfg.hosts / (mean * fanout), mean, fanout, cfg.seed);
+        } else {
+            work = load_scenario(argv[3], &n);
+            if (!work) {
+                fprintf(stderr, "Cenário inválido: %s\n", argv[3]);
+                free(cfgs);
+                return 1;
+            }
+        }
+        ClusterSummary sum;
+        if (count > 1) run_cluster_sweep(alg, argv[3], work, n, cfgs, count, threads);
+        else simulate_cluster(alg, argv[3], work, n, count == 1 ? &cfgs[0] : &cfg, 1, &sum);
+        free(cfgs);
+        free_processes(work, n);
+        return 0;
+    }
+    if (argc >= 3 && strcmp(argv[1], "tune") == 0) {
+        int jobs = 50000, eta = 3, threads = (int) sysconf(_SC_NPROCESSORS_ONLN);
+        double load = 0.8, mean = 1.0, weight = 1.0;
+        uint64_t seed = 42;
+        for (int i = 3; i + 1 < argc; i += 2) {
+            if (strcmp(argv[i], "--jobs") == 0) jobs = atoi(argv[i + 1]);
+            else if (strcmp(argv[i], "--load") == 0) load = atof(argv[i + 1]);
+            else if (strcmp(argv[i], "--mean") == 0) mean = atof(argv[i + 1]);
+            else if (strcmp(argv[i], "--seed") == 0) seed = strtoull(argv[i + 1], NULL, 10);
+            else if (strcmp(argv[i], "-w") == 0) weight = atof(argv[i + 1]);
+            else if (strcmp(argv[i], "--eta") == 0) eta = atoi(argv[i + 1]);
+            else if (strcmp(argv[i], "--threads") == 0) threads = atoi(argv[i + 1]);
+            else if (strcmp(argv[i], "-x") == 0 && load_param(argv[i + 1], "switch_cost", &switch_cost) != 0) {
+                fprintf(stderr, "Custo de troca inválido: %s\n", argv[i + 1]);
+                return 1;
+            }
+        }
+        if (jobs < 1) jobs = 1;
+        if (mean <= 0.0) mean = 1.0;
+        if (load <= 0.0) load = 0.8;
+        if (eta < 2) eta = 2;
+        if (threads < 1) threads = 1;
+        if (weight < 0.0) weight = 1.0;
+        int n;
+        Process *work;
+        if (strcmp(argv[2], "gen") == 0) {
+            n = jobs;
+            work = generate_workload(n, load / mean, mean, 1, seed);
+        } else {
+            work = load_scenario(argv[2], &n);
+            if (!work) {
+                fprintf(stderr, "Cenário inválido: %s\n", argv[2]);
+                return 1;
+            }
+        }
+        run_tune(argv[2], work, n, weight, eta, threads);
+        free_processes(work, n);
+        return 0;
+    }
+    if (argc >= 3 && strcmp(argv[1], "analytic") == 0) {
+        int jobs = 100000, k = 1, validate = 0;
+        double load = 0.8, mean = 1.0;
+        uint64_t seed = 42;
+        for (int i = 3; i + 1 < argc; i += 2) {
+            if (strcmp(argv[i], "--cpus") == 0) k = atoi(argv[i + 1]);
+            else if (strcmp(argv[i], "--jobs") == 0) jobs = atoi(argv[i + 1]);
+            else if (strcmp(argv[i], "--load") == 0) load = atof(argv[i + 1]);
+            else if (strcmp(argv[i], "--mean") == 0) mean = atof(argv[i + 1]);
+            else if (strcmp(argv[i], "--seed") == 0) seed = strtoull(argv[i + 1], NULL, 10);
+            else if (strcmp(argv[i], "--validate") == 0) validate = atoi(argv[i + 1]);
+            else if (strcmp(argv[i], "--epoch") == 0) epoch_len = atof(argv[i + 1]);
+            else if (strcmp(argv[i], "-x") == 0 && load_param(argv[i + 1], "switch_cost", &switch_cost) != 0) {
+                fprintf(stderr, "Custo de troca inválido: %s\n", argv[i + 1]);
+                return 1;
+            }
+        }
+        if (k < 1) k = 1;
+        if (jobs < 1) jobs = 1;
+        if (mean <= 0.0) mean = 1.0;
+        if (load <= 0.0) load = 0.8;
+        if (epoch_len <= 0.0) epoch_len = 1.0;
+        int n;
+        Process *work;
+        if (strcmp(argv[2], "gen") == 0) {
+            n = jobs;
+            work = generate_workload(n, load * k / mean, mean, 1, seed);
+        } else {
+            work = load_scenario(argv[2], &n);
+            if (!work) {
+                fprintf(stderr, "Cenário inválido: %s\n", argv[2]);
+                return 1;
+            }
+        }
+        int rc = run_analytic(argv[2], work, n, k, validate);
+        free_processes(work, n);
+        return rc;
+    }
+    if (argc >= 3 && strcmp(argv[1], "fast") == 0) {
+        const char *alg = argv[2];
+        long jobs = 10000000;
+        int threads = (int) sysconf(_SC_NPROCESSORS_ONLN), check = 0;
+        double load = 0.0, mean = 1.0;
+        uint64_t seed = 42;
+        for (int i = 3; i < argc; ++i) {
+            if (strcmp(argv[i], "--check") == 0) check = 1;
+            else if (i + 1 >= argc) break;
+            else if (strcmp(argv[i], "--jobs") == 0) jobs = atol(argv[++i]);
+            else if (strcmp(argv[i], "--load") == 0) load = atof(argv[++i]);
+            else if (strcmp(argv[i], "--mean") == 0) mean = atof(argv[++i]);
+            else if (strcmp(argv[i], "--seed") == 0) seed = strtoull(argv[++i], NULL, 10);
+            else if (strcmp(argv[i], "--threads") == 0) threads = atoi(argv[++i]);
+            else if (strcmp(argv[i], "-x") == 0 && load_param(argv[++i], "switch_cost", &switch_cost) != 0) {
+                fprintf(stderr, "Custo de troca inválido: %s\n", argv[i]);
+                return 1;
+            }
+        }
+        if (strcmp(alg, "fifo") != 0 && strcmp(alg, "sjf") != 0) {
+            fprintf(stderr, "Algoritmo inválido: %s (fifo | sjf)\n", alg);
+            return 1;
+        }
+        if (strcmp(alg, "sjf") == 0 && load > 0.0) {
+            fprintf(stderr, "sjf com chegadas não tem forma fechada\n");
+            return 1;
+        }
+        if (jobs < 1) jobs = 1;
+        if (mean <= 0.0) mean = 1.0;
+        if (threads < 1) threads = 1;
+        return run_fast(alg, jobs, load, mean, seed, threads, check);
+    }
+    if (argc >= 3 && strcmp(argv[1], "adversary") == 0) {
+        const char *alg = argv[2];
+        int metric = ADV_STARVATION, n = 8, pop = 128, gens = 200, top = 3;
+        int threads = (int) sysconf(_SC_NPROCESSORS_ONLN);
+        double budget = 40.0;
+        uint64_t seed = 42;
+        const char *prefix = "pior_";
+        for (int i = 3; i + 1 < argc; i += 2) {
+            if (strcmp(argv[i], "--procs") == 0) n = atoi(argv[i + 1]);
+            else if (strcmp(argv[i], "--budget") == 0) budget = atof(argv[i + 1]);
+            else if (strcmp(argv[i], "--pop") == 0) pop = atoi(argv[i + 1]);
+            else if (strcmp(argv[i], "--gens") == 0) gens = atoi(argv[i + 1]);
+            else if (strcmp(argv[i], "--top") == 0) top = atoi(argv[i + 1]);
+            else if (strcmp(argv[i], "--threads") == 0) threads = atoi(argv[i + 1]);
+            else if (strcmp(argv[i], "--seed") == 0) seed = strtoull(argv[i + 1], NULL, 10);
+            else if (strcmp(argv[i], "-o") == 0) prefix = argv[i + 1];
+            else if (strcmp(argv[i], "-x") == 0 && load_param(argv[i + 1], "switch_cost", &switch_cost) != 0) {
+                fprintf(stderr, "Custo de troca inválido: %s\n", argv[i + 1]);
+                return 1;
+            } else if (strcmp(argv[i], "--metric") == 0) {
+                metric = -1;
+                for (int m = 0; m < N_ADV_METRICS; ++m) if (strcmp(argv[i + 1], adv_metric_names[m]) == 0) metric = m;
+                if (metric < 0) {
+                    fprintf(stderr, "Métrica inválida: %s (starvation | p99 | slowdown)\n", argv[i + 1]);
+                    return 1;
+                }
+            }
+        }
+        if (!valid_algorithm(alg)) {
+            fprintf(stderr, "Algoritmo inválido: %s\n", alg);
+            return 1;
+        }
+        if (n < 1) n = 1;
+        if (n > ADV_MAX_PROCS) n = ADV_MAX_PROCS;
+        if (pop < 4) pop = 4;
+        if (gens < 0) gens = 0;
+        if (top < 1) top = 1;
+        if (threads < 1) threads = 1;
+        if (budget < n * ADV_CPU_MIN) budget = n * ADV_CPU_MIN;
+        return run_adversary(alg, (AdvMetric) metric, n, budget, pop, gens, top, threads, seed, prefix);
+    }
+    if (argc >= 3 && strcmp(argv[1], "green") == 0) {
+        if (strcmp(argv[2], "bench") == 0) {
+            long rounds = 1000000;
+            if (argc >= 5 && strcmp(argv[3], "-n") == 0) rounds = atol(argv[4]);
+            return run_green_bench(rounds);
+        }
+        if (argc < 4) {
+            usage(argv[0]);
+            return 1;
+        }
+        int workers = 2;
+        double scale = 0.01;
+        for (int i = 4; i + 1 < argc; i += 2) {
+            if (strcmp(argv[i], "-w") == 0) workers = atoi(argv[i + 1]);
+            else if (strcmp(argv[i], "-s") == 0) scale = atof(argv[i + 1]);
+        }
+        if (scale <= 0.0) scale = 0.01;
+        return run_green(argv[2], atoi(argv[3]), workers, scale);
+    }
+
+    /* separa opções (-j N) dos argumentos posicionais */
+    char *pos[3];
+    int npos = 0;
+    int workers = 1;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+            workers = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-x") == 0 && i + 1 < argc) {
+            if (load_param(argv[++i], "switch_cost", &switch_cost) != 0) {
+                fprintf(stderr, "Custo de troca inválido: %s\n", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "-i") == 0 && i + 1 < argc) {
+            if (load_param(argv[++i], "interference", &interference) != 0) {
+                fprintf(stderr, "Interferência inválida: %s\n", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--cpus") == 0 && i + 1 < argc) {
+            sim_cpus = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            sim_threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--epoch") == 0 && i + 1 < argc) {
+            epoch_len = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--place") == 0 && i + 1 < argc) {
+            placement = argv[++i];
+        } else if (npos < 3) {
+            pos[npos++] = argv[i];
+        }
+    }
+    if (npos < 2) {
+        usage(argv[0]);
+        return 1;
+    }
+    const char *alg = pos[0];
+    int repeat = 3;
+    if (npos >= 3) repeat = atoi(pos[2]);
+    if (repeat < 1) repeat = 1;
+    if (workers < 1) workers = 1;
+    if (sim_cpus < 1) sim_cpus = 1;
+    if (epoch_len <= 0.0) epoch_len = 1.0;
+    if (strcmp(placement, "rr") != 0 && strcmp(placement, "least") != 0 && strcmp(placement, "random") != 0) {
+        fprintf(stderr, "Colocação inválida: %s (rr | least | random)\n", placement);
+        return 1;
+    }
+
+    int base_n;
+    Process *base = load_scenario(pos[1], &base_n);
+    if (!base) {
+        fprintf(stderr, "Cenário inválido: %s\n", pos[1]);
+        return 1;
+    }
+    if (!valid_algorithm(alg)) {
+        fprintf(stderr, "Algoritmo inválido: %s\n", alg);
+        free_processes(base, base_n);
+        return 1;
+    }
+
+    /* runs will store pointers to result arrays for each run */
+    Result **runs = (Result**) malloc(sizeof(Result*) * repeat);
+    int proc_count = 0;
+    int ok_runs = 0;
+
+    if (workers > 1) {
+        RepeatCtx ctx = { alg, base, base_n };
+        int *counts = (int*) malloc(sizeof(int) * repeat);
+        Result **isolated = run_isolated(repeat, base_n, workers, repeat_task, &ctx, counts);
+        if (!isolated) {
+            fprintf(stderr, "mmap da região partilhada falhou\n");
+            return 1;
+        }
+        for (int r = 0; r < repeat; ++r) {
+            if (!isolated[r]) continue;
+            runs[ok_runs++] = isolated[r];
+            proc_count = counts[r];
+        }
+        free(isolated);
+        free(counts);
+        if (ok_runs == 0) {
+            fprintf(stderr, "Todas as repetições falharam\n");
+            return 1;
+        }
+    } else {
+        for (int r = 0; r < repeat; ++r) {
+            int out_count = 0;
+            runs[ok_runs++] = run_algorithm(alg, base, base_n, &out_count);
+            proc_count = out_count;
+        }
+    }
+
+    Result *avg = accumulate_results(runs, ok_runs, proc_count);
+    print_results(alg, pos[1], avg, proc_count);
+    if (multi_stats.cpus > 0) {
+        printf("CPUs: %d, makespan: %.3f, migrações: %ld, abrandamento médio: %.3f\n",
+               multi_stats.cpus, multi_stats.makespan, multi_stats.migrations, multi_stats.mean_slowdown);
+    }
+    print_bounds(base, base_n, sim_cpus, avg, proc_count);
+
+    /* cleanup */
+    for (int r = 0; r < ok_runs; ++r) free(runs[r]);
+    free(runs);
+    free(avg);
+    free_processes(base, base_n);
+
+    return 0;
+}
@@ -0,0 +1,344 @@
+/* capture.c
+ *
+ * Captura do stdout/stderr de muitos filhos sem copiar byte a byte.
+ * Os filhos são lançados com a API de launcher/launcher.h e o pai recolhe a
+ * saída por pipes (tamanho ajustado com F_SETPIPE_SZ), usando epoll.
+ *
+ * Modos:
+ *   file   : stdout de cada filho redirecionado para um ficheiro (como exec2)
+ *   splice : pipe -> ficheiro por filho com splice() (sem passar pelo pai)
+ *   tee    : como splice, mas tee() duplica tudo para um ficheiro agregado
+ *   arena  : read() direto para uma única arena (mmap), com índice de blocos
+ *   all    : corre todos os modos e compara o débito
+ *
+ * Nota: splice funciona para qualquer fd destino (ficheiro, socket, pipe);
+ * aqui usamos ficheiros em <dir> para comparar com o modo file.
+ *
+ * Uso:
+ *   ./capture [-m modo] [-k K] [-b bytes] [-p pipe] [-d dir] [comando args...]
+ * onde:
+ *   K     = número de filhos em simultâneo (default 16)
+ *   bytes = saída de cada filho no comando default (default 64 MB)
+ *   pipe  = tamanho de cada pipe em bytes (default 1 MB)
+ *   dir   = diretoria para os ficheiros de saída (default /tmp)
+ *   comando = default: head -c <bytes> /dev/zero
+ *
+ * Compilar:
+ *   gcc capture.c ../launcher/launcher.c -o capture -O2
+ *
+ * Exemplo:
+ *   ./capture -m all -k 32 -b 16777216
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/epoll.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+#include "../launcher/launcher.h"
+
+#define MAX_EVENTS 64
+#define ARENA_INITIAL (64UL << 20)
+
+typedef enum { MODE_FILE, MODE_SPLICE, MODE_TEE, MODE_ARENA, N_MODE } Mode;
+
+static const char *mode_names[N_MODE] = { "file", "splice", "tee", "arena" };
+
+/* Um stream capturado (stdout ou stderr de um filho) */
+typedef struct {
+    int child;
+    int is_err;
+    int fd;       /* lado de leitura do pipe */
+    int out_fd;   /* destino (splice/tee) */
+    int open;
+} Stream;
+
+/* Bloco dentro da arena */
+typedef struct {
+    int child;
+    int is_err;
+    size_t offset;
+    size_t len;
+} Chunk;
+
+typedef struct {
+    char *base;
+    size_t used;
+    size_t cap;
+    Chunk *chunks;
+    int chunk_count;
+    int chunk_cap;
+} Arena;
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* ------------------- Arena ------------------- */
+
+static int arena_init(Arena *a) {
+    a->cap = ARENA_INITIAL;
+    a->base = (char*) mmap(NULL, a->cap, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (a->base == MAP_FAILED) return -1;
+    a->used = 0;
+    a->chunk_cap = 1024;
+    a->chunk_count = 0;
+    a->chunks = (Chunk*) malloc(sizeof(Chunk) * a->chunk_cap);
+    return a->chunks ? 0 : -1;
+}
+
+static int arena_reserve(Arena *a, size_t need) {
+    if (a->used + need <= a->cap) return 0;
+    size_t cap = a->cap;
+    while (a->used + need > cap) cap *= 2;
+    char *base = (char*) mremap(a->base, a->cap, cap, MREMAP_MAYMOVE);
+    if (base == MAP_FAILED) return -1;
+    a->base = base;
+    a->cap = cap;
+    return 0;
+}
+
+static void arena_add_chunk(Arena *a, int child, int is_err, size_t offset, size_t len) {
+    /* junta ao bloco anterior se for contíguo e do mesmo stream */
+    if (a->chunk_count > 0) {
+        Chunk *last = &a->chunks[a->chunk_count - 1];
+        if (last->child == child && last->is_err == is_err && last->offset + last->len == offset) {
+            last->len += len;
+            return;
+        }
+    }
+    if (a->chunk_count == a->chunk_cap) {
+        a->chunk_cap *= 2;
+        a->chunks = (Chunk*) realloc(a->chunks, sizeof(Chunk) * a->chunk_cap);
+    }
+    a->chunks[a->chunk_count++] = (Chunk) { child, is_err, offset, len };
+}
+
+static void arena_free(Arena *a) {
+    munmap(a->base, a->cap);
+    free(a->chunks);
+}
+
+/* ------------------- Drenar streams ------------------- */
+
+/* Move exatamente len bytes (já presentes no pipe from) para to */
+static int splice_exact(int from, int to, ssize_t len) {
+    while (len > 0) {
+        ssize_t m = splice(from, NULL, to, NULL, len, SPLICE_F_MOVE);
+        if (m <= 0) return -1;
+        len -= m;
+    }
+    return 0;
+}
+
+/* Devolve bytes movidos; marca s->open = 0 no EOF. Com tee, tee_pipe é o
+ * pipe agregado (vazio entre chamadas): tee() copia o que está no pipe do
+ * filho para lá, e os mesmos t bytes vão para o ficheiro agregado e, com
+ * splice, para o ficheiro do filho, por isso os dois nunca divergem. */
+static ssize_t drain_splice(Stream *s, int pipe_size, const int *tee_pipe, int tee_out) {
+    ssize_t total = 0;
+    for (;;) {
+        ssize_t n;
+        if (tee_out >= 0) {
+            n = tee(s->fd, tee_pipe[1], pipe_size, SPLICE_F_NONBLOCK);
+            if (n > 0 && (splice_exact(tee_pipe[0], tee_out, n) != 0 || splice_exact(s->fd, s->out_fd, n) != 0)) {
+                s->open = 0;
+                return total;
+            }
+        } else {
+            n = splice(s->fd, NULL, s->out_fd, NULL, pipe_size, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+        }
+        if (n > 0) { total += n; continue; }
+        if (n == 0) s->open = 0;
+        else if (errno != EAGAIN) s->open = 0;
+        return total;
+    }
+}
+
+static ssize_t drain_arena(Stream *s, Arena *a, int pipe_size) {
+    ssize_t total = 0;
+    for (;;) {
+        if (arena_reserve(a, pipe_size) != 0) { s->open = 0; return total; }
+        ssize_t n = read(s->fd, a->base + a->used, pipe_size);
+        if (n > 0) {
+            arena_add_chunk(a, s->child, s->is_err, a->used, n);
+            a->used += n;
+            total += n;
+            continue;
+        }
+        if (n == 0 || errno != EAGAIN) s->open = 0;
+        return total;
+    }
+}
+
+/* ------------------- Execução de um modo ------------------- */
+
+static int run_mode(Mode mode, char **cmd, int k, int pipe_size, const char *dir) {
+    char path[512];
+    LaunchSpec *specs = (LaunchSpec*) calloc(k, sizeof(LaunchSpec));
+    pid_t *pids = (pid_t*) malloc(sizeof(pid_t) * k);
+    char **paths = (char**) calloc(k, sizeof(char*));
+    Stream *streams = (Stream*) calloc(2 * k, sizeof(Stream));
+    int epfd = epoll_create1(EPOLL_CLOEXEC);
+    int tee_pipe[2] = { -1, -1 };
+    int tee_out = -1;
+    Arena arena = { 0 };
+    int failed = 0;
+
+    if (mode == MODE_ARENA && arena_init(&arena) != 0) {
+        fprintf(stderr, "arena: mmap failed\n");
+        return -1;
+    }
+    if (mode == MODE_TEE) {
+        if (pipe2(tee_pipe, O_CLOEXEC) != 0) { perror("pipe2"); return -1; }
+        fcntl(tee_pipe[0], F_SETPIPE_SZ, pipe_size);
+        snprintf(path, sizeof(path), "%s/capture.all.out", dir);
+        tee_out = open(path, O_CREAT | O_WRONLY | O_TRUNC | O_CLOEXEC, 0644);
+    }
+
+    double t0 = now_s();
+    for (int c = 0; c < k; ++c) {
+        launch_spec_init(&specs[c], cmd);
+        if (mode == MODE_FILE) {
+            snprintf(path, sizeof(path), "%s/capture.%d.out", dir, c);
+            paths[c] = strdup(path);
+            specs[c].stdout_path = paths[c];
+        } else {
+            for (int e = 0; e < 2; ++e) {
+                int fds[2];
+                if (pipe2(fds, O_CLOEXEC) != 0) { perror("pipe2"); return -1; }
+                if (fcntl(fds[0], F_SETPIPE_SZ, pipe_size) < 0) perror("F_SETPIPE_SZ");
+                fcntl(fds[0], F_SETFL, O_NONBLOCK);
+                Stream *s = &streams[2 * c + e];
+                s->child = c;
+                s->is_err = e;
+                s->fd = fds[0];
+                s->open = 1;
+                s->out_fd = -1;
+                if (mode != MODE_ARENA) {
+                    snprintf(path, sizeof(path), "%s/capture.%d.%s", dir, c, e ? "err" : "out");
+                    s->out_fd = open(path, O_CREAT | O_WRONLY | O_TRUNC | O_CLOEXEC, 0644);
+                }
+                launch_spec_dup(&specs[c], fds[1], e ? STDERR_FILENO : STDOUT_FILENO);
+                struct epoll_event ev = { .events = EPOLLIN, .data.ptr = s };
+                epoll_ctl(epfd, EPOLL_CTL_ADD, fds[0], &ev);
+            }
+        }
+        pids[c] = launch(&specs[c], LAUNCH_SPAWN);
+        if (pids[c] < 0) {
+            perror("launch");
+            failed = 1;
+        }
+        /* o pai não precisa dos lados de escrita */
+        for (int d = 0; d < specs[c].dup_count; ++d) close(specs[c].dup_from[d]);
+    }
+
+    size_t bytes = 0;
+    int open_streams = (mode == MODE_FILE) ? 0 : 2 * k;
+    struct epoll_event events[MAX_EVENTS];
+    while (open_streams > 0) {
+        int ready = epoll_wait(epfd, events, MAX_EVENTS, -1);
+        if (ready < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        for (int i = 0; i < ready; ++i) {
+            Stream *s = (Stream*) events[i].data.ptr;
+            ssize_t moved = (mode == MODE_ARENA)
+                ? drain_arena(s, &arena, pipe_size)
+                : drain_splice(s, pipe_size, tee_pipe, tee_out);
+            if (moved > 0) bytes += moved;
+            if (!s->open) {
+                epoll_ctl(epfd, EPOLL_CTL_DEL, s->fd, NULL);
+                close(s->fd);
+                if (s->out_fd >= 0) close(s->out_fd);
+                open_streams--;
+            }
+        }
+    }
+    for (int c = 0; c < k; ++c) {
+        int status;
+        if (pids[c] > 0 && waitpid(pids[c], &status, 0) == pids[c]
+            && (!WIFEXITED(status) || WEXITSTATUS(status) != 0)) failed = 1;
+    }
+    double elapsed = now_s() - t0;
+
+    if (mode == MODE_FILE) {
+        for (int c = 0; c < k; ++c) {
+            struct stat st;
+            if (stat(paths[c], &st) == 0) bytes += st.st_size;
+        }
+    }
+    printf("%-7s | %6d | %10.1f | %8.3f | %9.1f | %s\n",
+           mode_names[mode], k, bytes / 1048576.0, elapsed, bytes / 1048576.0 / elapsed,
+           failed ? "falhou" : (mode == MODE_ARENA ? "arena" : dir));
+    if (mode == MODE_ARENA) printf("          arena: %d blocos, %zu bytes\n", arena.chunk_count, arena.used);
+
+    if (mode == MODE_ARENA) arena_free(&arena);
+    if (tee_out >= 0) { close(tee_out); close(tee_pipe[0]); close(tee_pipe[1]); }
+    for (int c = 0; c < k; ++c) free(paths[c]);
+    close(epfd);
+    free(paths);
+    free(streams);
+    free(pids);
+    free(specs);
+    return failed ? -1 : 0;
+}
+
+int main(int argc, char *argv[]) {
+    int all = 0;
+    Mode mode = MODE_SPLICE;
+    int k = 16, pipe_size = 1 << 20;
+    long long bytes = 64LL << 20;
+    const char *dir = "/tmp";
+
+    int i = 1;
+    for (; i < argc && argv[i][0] == '-'; ++i) {
+        if (strcmp(argv[i], "-m") == 0 && i + 1 < argc) {
+            const char *name = argv[++i];
+            int found = 0;
+            if (strcmp(name, "all") == 0) { all = 1; found = 1; }
+            for (int m = 0; m < N_MODE; ++m) if (strcmp(name, mode_names[m]) == 0) { mode = (Mode) m; found = 1; }
+            if (!found) { fprintf(stderr, "Modo inválido: %s\n", name); return 1; }
+        } else if (strcmp(argv[i], "-k") == 0 && i + 1 < argc) {
+            k = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-b") == 0 && i + 1 < argc) {
+            bytes = atoll(argv[++i]);
+        } else if (strcmp(argv[i], "-p") == 0 && i + 1 < argc) {
+            pipe_size = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-d") == 0 && i + 1 < argc) {
+            dir = argv[++i];
+        } else {
+            fprintf(stderr, "usage: capture [-m file|splice|tee|arena|all] [-k K] [-b bytes] [-p pipe] [-d dir] [comando args...]\n");
+            return 1;
+        }
+    }
+    if (k < 1) k = 1;
+    if (pipe_size < 4096) pipe_size = 4096;
+
+    char count[32];
+    snprintf(count, sizeof(count), "%lld", bytes);
+    char *default_cmd[] = { "head", "-c", count, "/dev/zero", NULL };
+    char **cmd = (i < argc) ? &argv[i] : default_cmd;
+
+    printf("%-7s | %6s | %10s | %8s | %9s | %s\n", "Modo", "Filhos", "MB", "tempo s", "MB/s", "destino");
+    printf("--------------------------------------------------------------\n");
+    int rc = 0;
+    if (all) {
+        for (int m = 0; m < N_MODE; ++m) rc |= run_mode((Mode) m, cmd, k, pipe_size, dir);
+    } else {
+        rc = run_mode(mode, cmd, k, pipe_size, dir);
+    }
+    printf("--------------------------------------------------------------\n");
+    return rc == 0 ? 0 : 1;
+}
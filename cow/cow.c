@@ -0,0 +1,243 @@
+/* cow.c
+ *
+ * Profiler do custo de copy-on-write após fork().
+ * O pai aloca e toca um working set, faz fork e o filho escreve numa fração
+ * das páginas. Para cada layout do working set mede:
+ *   fork    : duração do fork() no pai (us)
+ *   first   : latência da primeira escrita no filho (us)
+ *   write   : tempo total das escritas no filho (ms)
+ *   slowdown: write / mesmas escritas no pai sem fork
+ *   minflt  : page faults do filho durante as escritas (getrusage)
+ *   perf    : page faults medidos por perf_event_open (n/a se indisponível)
+ *
+ * Layouts:
+ *   4k         : páginas normais (MADV_NOHUGEPAGE)
+ *   thp        : transparent huge pages (MADV_HUGEPAGE)
+ *   wipeonfork : MADV_WIPEONFORK, o filho vê a região a zeros (sem cópia)
+ *   dontfork   : MADV_DONTFORK, a região não existe no filho; o filho
+ *                mapeia uma região nova do mesmo tamanho e escreve nela
+ *
+ * Uso:
+ *   ./cow [-s MB] [-f fração] [layout...]
+ * onde:
+ *   MB     = tamanho do working set (default 256)
+ *   fração = fração das páginas escrita pelo filho, 0..1 (default 0.5)
+ *
+ * Compilar:
+ *   gcc cow.c -o cow -O2
+ *
+ * Exemplo:
+ *   ./cow -s 1024 -f 0.1 4k thp
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <sys/ioctl.h>
+#include <linux/perf_event.h>
+
+#define HUGE_SIZE (2UL * 1024 * 1024)
+
+typedef enum { LAYOUT_4K, LAYOUT_THP, LAYOUT_WIPEONFORK, LAYOUT_DONTFORK, N_LAYOUT } Layout;
+
+static const char *layout_names[N_LAYOUT] = { "4k", "thp", "wipeonfork", "dontfork" };
+
+/* resultado enviado pelo filho ao pai através de um pipe */
+typedef struct {
+    double first_us;
+    double write_ms;
+    long minflt;
+    long long perf_faults; /* -1 se perf_event_open indisponível */
+} ChildReport;
+
+static long page_size;
+
+static double now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static long minor_faults(void) {
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+    return ru.ru_minflt;
+}
+
+static int open_fault_counter(void) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_SOFTWARE;
+    attr.config = PERF_COUNT_SW_PAGE_FAULTS;
+    attr.disabled = 1;
+    attr.exclude_kernel = 0;
+    return (int) syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+/* Mapeia bytes alinhados a 2 MB (necessário para THP) */
+static char *map_region(size_t bytes) {
+    size_t len = bytes + HUGE_SIZE;
+    char *raw = (char*) mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED) return NULL;
+    char *aligned = (char*) (((uintptr_t) raw + HUGE_SIZE - 1) & ~(HUGE_SIZE - 1));
+    if (aligned > raw) munmap(raw, aligned - raw);
+    size_t tail = (raw + len) - (aligned + bytes);
+    if (tail > 0) munmap(aligned + bytes, tail);
+    return aligned;
+}
+
+/* Escreve em `count` páginas espalhadas uniformemente pela região.
+ * Devolve a latência da primeira escrita em *first_us. */
+static void write_pages(char *mem, size_t npages, size_t count, char value, double *first_us) {
+    if (count == 0) { *first_us = 0.0; return; }
+    double t0 = now_us();
+    mem[0] = value;
+    *first_us = now_us() - t0;
+    for (size_t i = 1; i < count; ++i) {
+        size_t page = i * npages / count;
+        mem[page * page_size] = value;
+    }
+}
+
+static void child_main(char *mem, size_t bytes, size_t count, Layout layout, int out_fd) {
+    ChildReport rep;
+    size_t npages = bytes / page_size;
+    if (layout == LAYOUT_DONTFORK) {
+        /* a região não foi herdada: o worker constrói o seu próprio estado */
+        mem = map_region(bytes);
+        if (!mem) _exit(1);
+    }
+    int perf_fd = open_fault_counter();
+    if (perf_fd >= 0) {
+        ioctl(perf_fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(perf_fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+    long flt0 = minor_faults();
+    double t0 = now_us();
+    write_pages(mem, npages, count, 2, &rep.first_us);
+    rep.write_ms = (now_us() - t0) / 1e3;
+    rep.minflt = minor_faults() - flt0;
+    rep.perf_faults = -1;
+    if (perf_fd >= 0) {
+        long long value;
+        ioctl(perf_fd, PERF_EVENT_IOC_DISABLE, 0);
+        if (read(perf_fd, &value, sizeof(value)) == sizeof(value)) rep.perf_faults = value;
+        close(perf_fd);
+    }
+    if (write(out_fd, &rep, sizeof(rep)) != sizeof(rep)) _exit(1);
+    _exit(0);
+}
+
+static int run_layout(Layout layout, size_t mb, double fraction) {
+    size_t bytes = mb << 20;
+    size_t npages = bytes / page_size;
+    size_t count = (size_t) (fraction * npages);
+    char *mem = map_region(bytes);
+    if (!mem) {
+        fprintf(stderr, "mmap de %zu MB falhou\n", mb);
+        return -1;
+    }
+    int advice = MADV_NOHUGEPAGE;
+    if (layout == LAYOUT_THP) advice = MADV_HUGEPAGE;
+    if (madvise(mem, bytes, advice) != 0) perror("madvise");
+    memset(mem, 1, bytes); /* working set do pai totalmente residente */
+
+    /* referência: as mesmas escritas no pai, sem COW pendente */
+    double first_ref;
+    double t0 = now_us();
+    write_pages(mem, npages, count, 3, &first_ref);
+    double ref_ms = (now_us() - t0) / 1e3;
+
+    if (layout == LAYOUT_WIPEONFORK && madvise(mem, bytes, MADV_WIPEONFORK) != 0) {
+        perror("madvise(MADV_WIPEONFORK)");
+        munmap(mem, bytes);
+        return -1;
+    }
+    if (layout == LAYOUT_DONTFORK && madvise(mem, bytes, MADV_DONTFORK) != 0) {
+        perror("madvise(MADV_DONTFORK)");
+        munmap(mem, bytes);
+        return -1;
+    }
+
+    int fds[2];
+    if (pipe(fds) != 0) { perror("pipe"); munmap(mem, bytes); return -1; }
+    double f0 = now_us();
+    int rc = fork();
+    if (rc < 0) {
+        fprintf(stderr, "fork failed\n");
+        exit(1);
+    } else if (rc == 0) {
+        close(fds[0]);
+        child_main(mem, bytes, count, layout, fds[1]);
+    }
+    double fork_us = now_us() - f0;
+    close(fds[1]);
+
+    ChildReport rep;
+    ssize_t got = read(fds[0], &rep, sizeof(rep));
+    close(fds[0]);
+    int status;
+    waitpid(rc, &status, 0);
+    munmap(mem, bytes);
+    if (got != sizeof(rep) || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        fprintf(stderr, "filho falhou (layout %s)\n", layout_names[layout]);
+        return -1;
+    }
+
+    char perf[24];
+    if (rep.perf_faults < 0) strcpy(perf, "n/a");
+    else snprintf(perf, sizeof(perf), "%lld", rep.perf_faults);
+    printf("%-10s | %8.1f | %8.2f | %9.3f | %8.2f | %8ld | %8s\n",
+           layout_names[layout], fork_us, rep.first_us, rep.write_ms,
+           ref_ms > 0 ? rep.write_ms / ref_ms : 0.0, rep.minflt, perf);
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    size_t mb = 256;
+    double fraction = 0.5;
+    int selected[N_LAYOUT] = { 0 };
+    int any_selected = 0;
+    page_size = sysconf(_SC_PAGESIZE);
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            mb = (size_t) atol(argv[++i]);
+        } else if (strcmp(argv[i], "-f") == 0 && i + 1 < argc) {
+            fraction = atof(argv[++i]);
+        } else {
+            int found = 0;
+            for (int l = 0; l < N_LAYOUT; ++l) {
+                if (strcmp(argv[i], layout_names[l]) == 0) { selected[l] = 1; found = 1; }
+            }
+            if (!found) {
+                fprintf(stderr, "usage: cow [-s MB] [-f fração] [4k|thp|wipeonfork|dontfork...]\n");
+                return 1;
+            }
+            any_selected = 1;
+        }
+    }
+    if (mb < 1) mb = 1;
+    if (fraction < 0.0) fraction = 0.0;
+    if (fraction > 1.0) fraction = 1.0;
+    if (!any_selected) for (int l = 0; l < N_LAYOUT; ++l) selected[l] = 1;
+
+    printf("working set: %zu MB, fração escrita pelo filho: %.2f\n", mb, fraction);
+    printf("%-10s | %8s | %8s | %9s | %8s | %8s | %8s\n",
+           "Layout", "fork us", "first us", "write ms", "slowdown", "minflt", "perf");
+    printf("---------------------------------------------------------------------------\n");
+    for (int l = 0; l < N_LAYOUT; ++l) {
+        if (selected[l]) run_layout((Layout) l, mb, fraction);
+    }
+    printf("---------------------------------------------------------------------------\n");
+    return 0;
+}
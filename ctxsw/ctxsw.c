@@ -0,0 +1,345 @@
+/* ctxsw.c
+ *
+ * Latência de troca de contexto e de IPC (ping-pong de ida e volta).
+ * Dois lados passam um testemunho N vezes; o iniciador mede cada ida e volta:
+ *   pipe       : dois processos (fork), um pipe em cada sentido
+ *   eventfd    : dois processos, um eventfd em cada sentido
+ *   socketpair : dois processos, socketpair(AF_UNIX, SOCK_STREAM)
+ *   futex      : duas threads, FUTEX_WAIT/FUTEX_WAKE numa palavra partilhada
+ *   yield      : duas threads, espera ativa com sched_yield() até ser a sua vez
+ *
+ * Cada mecanismo corre com os dois lados fixos no mesmo CPU (cada ida e volta
+ * são duas trocas de contexto) e em CPUs diferentes (só a latência de
+ * acordar). Mostra percentis em ns e a troca estimada (p50 / 2).
+ *
+ * Com -o escreve um ficheiro chave=valor que o simulador lê com
+ * "./simulador <algorithm> <scenario> -x ficheiro": switch_cost é a troca
+ * entre processos (pipe, mesmo CPU) em segundos.
+ *
+ * Uso:
+ *   ./ctxsw [-n N] [-c cpuA,cpuB] [-o ficheiro] [mecanismo...]
+ * onde:
+ *   N    = idas e voltas por medição (default 100000)
+ *   cpuA = CPU do iniciador, cpuB = CPU do outro lado em "cores diferentes"
+ *          (default 0,1)
+ *
+ * Compilar:
+ *   gcc ctxsw.c -o ctxsw -O2 -pthread
+ *
+ * Exemplo:
+ *   ./ctxsw -n 200000 -c 2,3 -o ctxsw.conf pipe futex
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <errno.h>
+#include <sched.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <time.h>
+#include <linux/futex.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+
+#define WARMUP 1000
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/* ------------------- Canais ------------------- */
+/* Lado 0 = iniciador, lado 1 = o outro. send(c, to) passa o testemunho ao
+ * lado `to`; recv(c, me) espera que chegue ao lado `me`. */
+
+typedef struct {
+    int fd[2][2];       /* pipe/eventfd: fd[para quem][0 leitura, 1 escrita] */
+    atomic_int *word;   /* futex/yield: de quem é a vez (MAP_SHARED) */
+} Chan;
+
+typedef struct {
+    const char *name;
+    int threads;        /* 1: threads do mesmo processo; 0: fork */
+    int (*setup)(Chan *c);
+    void (*send)(Chan *c, int to);
+    void (*recv)(Chan *c, int me);
+    void (*teardown)(Chan *c);
+} Mechanism;
+
+static void write_full(int fd, const void *buf, size_t len) {
+    while (write(fd, buf, len) < 0 && errno == EINTR) { }
+}
+
+static void read_full(int fd, void *buf, size_t len) {
+    while (read(fd, buf, len) < 0 && errno == EINTR) { }
+}
+
+static void close_fds(Chan *c) {
+    for (int i = 0; i < 2; ++i) {
+        for (int j = 0; j < 2; ++j) if (c->fd[i][j] >= 0) close(c->fd[i][j]);
+    }
+}
+
+static int pipe_setup(Chan *c) {
+    if (pipe(c->fd[0]) != 0) return -1;
+    return pipe(c->fd[1]);
+}
+
+static void pipe_send(Chan *c, int to) {
+    char b = 1;
+    write_full(c->fd[to][1], &b, 1);
+}
+
+static void pipe_recv(Chan *c, int me) {
+    char b;
+    read_full(c->fd[me][0], &b, 1);
+}
+
+static int eventfd_setup(Chan *c) {
+    for (int i = 0; i < 2; ++i) {
+        c->fd[i][0] = eventfd(0, EFD_CLOEXEC);
+        c->fd[i][1] = -1;
+        if (c->fd[i][0] < 0) return -1;
+    }
+    return 0;
+}
+
+static void eventfd_send(Chan *c, int to) {
+    uint64_t v = 1;
+    write_full(c->fd[to][0], &v, sizeof(v));
+}
+
+static void eventfd_recv(Chan *c, int me) {
+    uint64_t v;
+    read_full(c->fd[me][0], &v, sizeof(v));
+}
+
+/* fd[0] é o lado 0 e fd[1] o lado 1 do socketpair */
+static int socket_setup(Chan *c) {
+    int sv[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sv) != 0) return -1;
+    c->fd[0][0] = sv[0];
+    c->fd[1][0] = sv[1];
+    c->fd[0][1] = c->fd[1][1] = -1;
+    return 0;
+}
+
+static void socket_send(Chan *c, int to) {
+    char b = 1;
+    write_full(c->fd[1 - to][0], &b, 1);
+}
+
+static void socket_recv(Chan *c, int me) {
+    char b;
+    read_full(c->fd[me][0], &b, 1);
+}
+
+static int word_setup(Chan *c) {
+    c->word = (atomic_int*) mmap(NULL, sizeof(atomic_int), PROT_READ | PROT_WRITE,
+                                 MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (c->word == MAP_FAILED) return -1;
+    atomic_store(c->word, 0);
+    return 0;
+}
+
+static void word_teardown(Chan *c) {
+    munmap(c->word, sizeof(atomic_int));
+}
+
+static void futex_send(Chan *c, int to) {
+    atomic_store(c->word, to);
+    syscall(SYS_futex, c->word, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+}
+
+static void futex_recv(Chan *c, int me) {
+    int v;
+    while ((v = atomic_load(c->word)) != me)
+        syscall(SYS_futex, c->word, FUTEX_WAIT_PRIVATE, v, NULL, NULL, 0);
+}
+
+static void yield_send(Chan *c, int to) {
+    atomic_store(c->word, to);
+}
+
+static void yield_recv(Chan *c, int me) {
+    while (atomic_load(c->word) != me) sched_yield();
+}
+
+static const Mechanism mechanisms[] = {
+    { "pipe",       0, pipe_setup,    pipe_send,    pipe_recv,    close_fds },
+    { "eventfd",    0, eventfd_setup, eventfd_send, eventfd_recv, close_fds },
+    { "socketpair", 0, socket_setup,  socket_send,  socket_recv,  close_fds },
+    { "futex",      1, word_setup,    futex_send,   futex_recv,   word_teardown },
+    { "yield",      1, word_setup,    yield_send,   yield_recv,   word_teardown },
+};
+#define N_MECH ((int) (sizeof(mechanisms) / sizeof(mechanisms[0])))
+
+/* ------------------- Ping-pong ------------------- */
+
+typedef struct {
+    const Mechanism *m;
+    Chan *chan;
+    long rounds;
+    int cpu;
+} Responder;
+
+static void pin(int cpu) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    sched_setaffinity(0, sizeof(set), &set); /* 0 = a thread que chama */
+}
+
+static void *responder(void *arg) {
+    Responder *r = (Responder*) arg;
+    pin(r->cpu);
+    for (long i = 0; i < r->rounds; ++i) {
+        r->m->recv(r->chan, 1);
+        r->m->send(r->chan, 0);
+    }
+    return NULL;
+}
+
+/* Mede n idas e voltas em lat (ns); devolve -1 se falhou */
+static int ping_pong(const Mechanism *m, int cpu_a, int cpu_b, long n, double *lat) {
+    Chan chan;
+    memset(&chan, 0xff, sizeof(chan.fd));
+    chan.word = NULL;
+    if (m->setup(&chan) != 0) {
+        perror(m->name);
+        return -1;
+    }
+    Responder r = { m, &chan, n + WARMUP, cpu_b };
+    pthread_t thread;
+    pid_t pid = -1;
+    if (m->threads) {
+        if (pthread_create(&thread, NULL, responder, &r) != 0) return -1;
+    } else {
+        pid = fork();
+        if (pid < 0) return -1;
+        if (pid == 0) {
+            responder(&r);
+            _exit(0);
+        }
+    }
+
+    cpu_set_t saved;
+    sched_getaffinity(0, sizeof(saved), &saved);
+    pin(cpu_a);
+    for (long i = 0; i < n + WARMUP; ++i) {
+        double t0 = now_ns();
+        m->send(&chan, 1);
+        m->recv(&chan, 0);
+        if (i >= WARMUP) lat[i - WARMUP] = now_ns() - t0;
+    }
+    sched_setaffinity(0, sizeof(saved), &saved);
+
+    if (m->threads) pthread_join(thread, NULL);
+    else waitpid(pid, NULL, 0);
+    m->teardown(&chan);
+    return 0;
+}
+
+static int cmp_double(const void *a, const void *b) {
+    double x = *(const double*) a, y = *(const double*) b;
+    return (x > y) - (x < y);
+}
+
+static double percentile(double *sorted, long n, double p) {
+    long idx = (long) (p * (n - 1) + 0.5);
+    return sorted[idx];
+}
+
+int main(int argc, char *argv[]) {
+    long n = 100000;
+    int cpu_a = 0, cpu_b = 1;
+    const char *out_path = NULL;
+    int selected[N_MECH] = { 0 };
+    int any_selected = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            n = atol(argv[++i]);
+        } else if (strcmp(argv[i], "-c") == 0 && i + 1 < argc) {
+            if (sscanf(argv[++i], "%d,%d", &cpu_a, &cpu_b) < 1) cpu_a = 0;
+        } else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            out_path = argv[++i];
+        } else {
+            int found = 0;
+            for (int m = 0; m < N_MECH; ++m) {
+                if (strcmp(argv[i], mechanisms[m].name) == 0) { selected[m] = 1; found = 1; }
+            }
+            if (!found) {
+                fprintf(stderr, "usage: ctxsw [-n N] [-c cpuA,cpuB] [-o ficheiro] [pipe|eventfd|socketpair|futex|yield...]\n");
+                return 1;
+            }
+            any_selected = 1;
+        }
+    }
+    if (!any_selected) for (int m = 0; m < N_MECH; ++m) selected[m] = 1;
+    if (n < 1) n = 1;
+
+    cpu_set_t allowed;
+    sched_getaffinity(0, sizeof(allowed), &allowed);
+    if (!CPU_ISSET(cpu_a, &allowed)) {
+        fprintf(stderr, "CPU %d não disponível\n", cpu_a);
+        return 1;
+    }
+    int cross = cpu_b != cpu_a && CPU_ISSET(cpu_b, &allowed);
+
+    FILE *out = NULL;
+    if (out_path && !(out = fopen(out_path, "w"))) {
+        perror(out_path);
+        return 1;
+    }
+
+    double *lat = (double*) malloc(sizeof(double) * n);
+    double switch_cost = -1.0;
+    printf("idas e voltas: %ld, CPUs: %d e %d\n", n, cpu_a, cross ? cpu_b : cpu_a);
+    printf("%-10s | %-9s | %8s | %8s | %8s | %8s | %9s | %8s\n",
+           "Mecanismo", "CPUs", "p50 ns", "p90 ns", "p99 ns", "p99.9 ns", "max ns", "troca ns");
+    printf("-----------------------------------------------------------------------------------------\n");
+    for (int m = 0; m < N_MECH; ++m) {
+        if (!selected[m]) continue;
+        for (int same = 1; same >= 0; --same) {
+            if (!same && !cross) {
+                printf("%-10s | %-9s | ignorado (só há um CPU disponível)\n", mechanisms[m].name, "diferente");
+                continue;
+            }
+            if (ping_pong(&mechanisms[m], cpu_a, same ? cpu_a : cpu_b, n, lat) != 0) {
+                fprintf(stderr, "%s falhou\n", mechanisms[m].name);
+                continue;
+            }
+            qsort(lat, n, sizeof(double), cmp_double);
+            double p50 = percentile(lat, n, 0.50);
+            printf("%-10s | %-9s | %8.0f | %8.0f | %8.0f | %8.0f | %9.0f | %8.0f\n",
+                   mechanisms[m].name, same ? "mesmo" : "diferente", p50,
+                   percentile(lat, n, 0.90), percentile(lat, n, 0.99),
+                   percentile(lat, n, 0.999), lat[n - 1], p50 / 2);
+            if (out) {
+                const char *where = same ? "same" : "cross";
+                fprintf(out, "%s.%s.p50_ns=%.0f\n", mechanisms[m].name, where, p50);
+                fprintf(out, "%s.%s.p99_ns=%.0f\n", mechanisms[m].name, where, percentile(lat, n, 0.99));
+            }
+            if (same && strcmp(mechanisms[m].name, "pipe") == 0) switch_cost = p50 / 2 / 1e9;
+            else if (same && switch_cost < 0.0 && !mechanisms[m].threads) switch_cost = p50 / 2 / 1e9;
+        }
+    }
+    printf("-----------------------------------------------------------------------------------------\n");
+    if (switch_cost >= 0.0) {
+        printf("custo de uma troca entre processos (mesmo CPU): %.9f s  ->  ./simulador <alg> <cen> -x %.9f\n",
+               switch_cost, switch_cost);
+        if (out) fprintf(out, "switch_cost=%.9f\n", switch_cost);
+    }
+    if (out) fclose(out);
+    free(lat);
+    return 0;
+}
@@ -0,0 +1,279 @@
+/* launcher.c
+ *
+ * Implementação de launcher.h. Ver launcher/main.c para o exemplo de uso.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <signal.h>
+#include <spawn.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+#include "launcher.h"
+
+#define CHILD_STACK (64 * 1024)
+#define OUTPUT_MODE 0644
+
+extern char **environ;
+
+/* ------------------- Spec e ambiente ------------------- */
+
+void launch_spec_init(LaunchSpec *spec, char *const *argv) {
+    memset(spec, 0, sizeof(*spec));
+    spec->argv = argv;
+}
+
+int launch_spec_dup(LaunchSpec *spec, int fd, int target_fd) {
+    if (spec->dup_count >= LAUNCH_MAX_DUPS) return -1;
+    spec->dup_from[spec->dup_count] = fd;
+    spec->dup_to[spec->dup_count] = target_fd;
+    spec->dup_count++;
+    return 0;
+}
+
+char **launch_env_build(char *const *overrides) {
+    int base = 0, extra = 0;
+    while (environ[base]) base++;
+    while (overrides && overrides[extra]) extra++;
+    char **env = (char**) malloc(sizeof(char*) * (base + extra + 1));
+    if (!env) return NULL;
+    memcpy(env, environ, sizeof(char*) * base);
+    int count = base;
+    for (int i = 0; i < extra; ++i) {
+        const char *eq = strchr(overrides[i], '=');
+        size_t name_len = eq ? (size_t) (eq - overrides[i]) : strlen(overrides[i]);
+        int replaced = 0;
+        for (int j = 0; j < count; ++j) {
+            if (strncmp(env[j], overrides[i], name_len) == 0 && env[j][name_len] == '=') {
+                env[j] = overrides[i];
+                replaced = 1;
+                break;
+            }
+        }
+        if (!replaced) env[count++] = overrides[i];
+    }
+    env[count] = NULL;
+    return env;
+}
+
+void launch_env_free(char **env) {
+    free(env);
+}
+
+/* ------------------- Filho (vfork/fork) ------------------- */
+
+static int redirect(const char *path, int flags, int target_fd) {
+    int fd = open(path, flags, OUTPUT_MODE);
+    if (fd < 0) return -1;
+    if (fd != target_fd) {
+        if (dup2(fd, target_fd) < 0) return -1;
+        close(fd);
+    }
+    return 0;
+}
+
+/* Aplica redirecionamentos e faz exec. Só regressa em caso de erro,
+ * devolvendo o errno. Apenas usa chamadas async-signal-safe. */
+static int child_exec(const LaunchSpec *spec) {
+    if (spec->stdin_path && redirect(spec->stdin_path, O_RDONLY, STDIN_FILENO) < 0) return errno;
+    if (spec->stdout_path && redirect(spec->stdout_path, O_CREAT|O_WRONLY|O_TRUNC, STDOUT_FILENO) < 0) return errno;
+    if (spec->stderr_path && redirect(spec->stderr_path, O_CREAT|O_WRONLY|O_TRUNC, STDERR_FILENO) < 0) return errno;
+    for (int i = 0; i < spec->dup_count; ++i) {
+        if (dup2(spec->dup_from[i], spec->dup_to[i]) < 0) return errno;
+    }
+    execvpe(spec->argv[0], spec->argv, spec->envp ? spec->envp : environ);
+    return errno;
+}
+
+typedef struct {
+    const LaunchSpec *spec;
+    sigset_t mask;    /* máscara do pai antes de bloquear tudo */
+    volatile int err; /* escrito pelo filho (memória partilhada com CLONE_VM) */
+} VforkArgs;
+
+/* Como no posix_spawn da glibc: o filho nasce com todos os sinais
+ * bloqueados, para nenhum handler do pai correr sobre a memória e a stack
+ * partilhadas; repõe os handlers instalados a SIG_DFL (a tabela é do filho,
+ * sem CLONE_SIGHAND) e só depois restaura a máscara original. */
+static int vfork_child(void *arg) {
+    VforkArgs *a = (VforkArgs*) arg;
+    struct sigaction sa;
+    for (int sig = 1; sig < NSIG; ++sig) {
+        if (sigaction(sig, NULL, &sa) != 0) continue;
+        if (sa.sa_handler == SIG_IGN || sa.sa_handler == SIG_DFL) continue;
+        sa.sa_handler = SIG_DFL;
+        sa.sa_flags = 0;
+        sigemptyset(&sa.sa_mask);
+        sigaction(sig, &sa, NULL);
+    }
+    sigprocmask(SIG_SETMASK, &a->mask, NULL);
+    a->err = child_exec(a->spec);
+    _exit(127);
+}
+
+/* ------------------- Métodos ------------------- */
+
+static pid_t launch_spawn(const LaunchSpec *spec) {
+    posix_spawn_file_actions_t fa;
+    posix_spawn_file_actions_init(&fa);
+    if (spec->stdin_path)
+        posix_spawn_file_actions_addopen(&fa, STDIN_FILENO, spec->stdin_path, O_RDONLY, 0);
+    if (spec->stdout_path)
+        posix_spawn_file_actions_addopen(&fa, STDOUT_FILENO, spec->stdout_path, O_CREAT|O_WRONLY|O_TRUNC, OUTPUT_MODE);
+    if (spec->stderr_path)
+        posix_spawn_file_actions_addopen(&fa, STDERR_FILENO, spec->stderr_path, O_CREAT|O_WRONLY|O_TRUNC, OUTPUT_MODE);
+    for (int i = 0; i < spec->dup_count; ++i)
+        posix_spawn_file_actions_adddup2(&fa, spec->dup_from[i], spec->dup_to[i]);
+
+    pid_t pid;
+    int rc = posix_spawnp(&pid, spec->argv[0], &fa, NULL, spec->argv,
+                          spec->envp ? spec->envp : environ);
+    posix_spawn_file_actions_destroy(&fa);
+    if (rc != 0) {
+        errno = rc;
+        return -1;
+    }
+    return pid;
+}
+
+static pid_t launch_fork(const LaunchSpec *spec) {
+    /* pipe com O_CLOEXEC: fecha no exec; se o exec falhar o filho escreve o errno */
+    int fds[2];
+    if (pipe2(fds, O_CLOEXEC) != 0) return -1;
+    pid_t rc = fork();
+    if (rc < 0) {
+        close(fds[0]);
+        close(fds[1]);
+        return -1;
+    } else if (rc == 0) {
+        close(fds[0]);
+        int err = child_exec(spec);
+        if (write(fds[1], &err, sizeof(err)) < 0) { /* nada a fazer */ }
+        _exit(127);
+    }
+    close(fds[1]);
+    int err;
+    ssize_t got;
+    do {
+        got = read(fds[0], &err, sizeof(err));
+    } while (got < 0 && errno == EINTR);
+    close(fds[0]);
+    if (got == sizeof(err)) {
+        waitpid(rc, NULL, 0);
+        errno = err;
+        return -1;
+    }
+    return rc;
+}
+
+static pid_t launch_vfork(const LaunchSpec *spec) {
+    /* o pai fica suspenso até ao exec, por isso a stack do filho pode viver aqui */
+    char stack[CHILD_STACK] __attribute__((aligned(16)));
+    VforkArgs args = { .spec = spec, .err = 0 };
+    sigset_t all;
+    sigfillset(&all);
+    sigprocmask(SIG_BLOCK, &all, &args.mask);
+    pid_t rc = clone(vfork_child, stack + sizeof(stack), CLONE_VM | CLONE_VFORK | SIGCHLD, &args);
+    int saved = errno;
+    sigprocmask(SIG_SETMASK, &args.mask, NULL);
+    errno = saved;
+    if (rc < 0) {
+        if (errno == ENOSYS || errno == EINVAL || errno == EPERM) return launch_fork(spec);
+        return -1;
+    }
+    if (args.err != 0) {
+        waitpid(rc, NULL, 0);
+        errno = args.err;
+        return -1;
+    }
+    return rc;
+}
+
+pid_t launch(const LaunchSpec *spec, LaunchMethod method) {
+    if (!spec || !spec->argv || !spec->argv[0]) {
+        errno = EINVAL;
+        return -1;
+    }
+    switch (method) {
+    case LAUNCH_SPAWN: return launch_spawn(spec);
+    case LAUNCH_VFORK: return launch_vfork(spec);
+    case LAUNCH_FORK:  return launch_fork(spec);
+    }
+    errno = EINVAL;
+    return -1;
+}
+
+/* ------------------- Lote ------------------- */
+
+typedef struct {
+    pid_t pid;
+    int index;
+} Slot;
+
+int launch_batch(const LaunchSpec *specs, int n, LaunchMethod method, int max_inflight, int *statuses) {
+    if (max_inflight < 1) max_inflight = 1;
+    Slot *slots = (Slot*) malloc(sizeof(Slot) * max_inflight);
+    if (!slots) return n;
+    for (int i = 0; i < max_inflight; ++i) slots[i].pid = 0;
+
+    int next = 0, running = 0, failures = 0;
+    while (next < n || running > 0) {
+        /* encher as slots livres */
+        for (int s = 0; s < max_inflight && next < n; ++s) {
+            if (slots[s].pid != 0) continue;
+            pid_t pid = launch(&specs[next], method);
+            if (pid < 0) {
+                if (statuses) statuses[next] = -1;
+                failures++;
+            } else {
+                slots[s].pid = pid;
+                slots[s].index = next;
+                running++;
+            }
+            next++;
+        }
+        if (running == 0) continue;
+
+        int status;
+        pid_t done = waitpid(-1, &status, 0);
+        if (done < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        for (int s = 0; s < max_inflight; ++s) {
+            if (slots[s].pid != done) continue;
+            if (statuses) statuses[slots[s].index] = status;
+            if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) failures++;
+            slots[s].pid = 0;
+            running--;
+            break;
+        }
+    }
+    free(slots);
+    return failures;
+}
+
+/* ------------------- Nomes ------------------- */
+
+static const char *method_names[] = { "spawn", "vfork", "fork" };
+
+const char *launch_method_name(LaunchMethod method) {
+    return method_names[method];
+}
+
+int launch_method_parse(const char *name, LaunchMethod *out) {
+    for (int i = 0; i < 3; ++i) {
+        if (strcmp(name, method_names[i]) == 0) {
+            *out = (LaunchMethod) i;
+            return 0;
+        }
+    }
+    return -1;
+}
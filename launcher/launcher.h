@@ -0,0 +1,57 @@
+/* launcher.h
+ *
+ * API para lançar processos sem o custo de um fork() completo.
+ * Métodos:
+ *   LAUNCH_SPAWN : posix_spawnp() com file actions (default)
+ *   LAUNCH_VFORK : clone(CLONE_VM|CLONE_VFORK) + execvpe()
+ *   LAUNCH_FORK  : fork() + execvpe(), como em exec2/exec2.c (fallback)
+ * Se LAUNCH_VFORK não estiver disponível (clone falha com ENOSYS/EINVAL/EPERM)
+ * o lançamento recai automaticamente em LAUNCH_FORK.
+ */
+
+#ifndef LAUNCHER_H
+#define LAUNCHER_H
+
+#include <sys/types.h>
+
+typedef enum { LAUNCH_SPAWN, LAUNCH_VFORK, LAUNCH_FORK } LaunchMethod;
+
+#define LAUNCH_MAX_DUPS 4
+
+typedef struct {
+    char *const *argv;         /* argv[0] é procurado no PATH */
+    char *const *envp;         /* NULL = herdar environ */
+    const char *stdin_path;    /* NULL = herdar */
+    const char *stdout_path;   /* NULL = herdar; criado/truncado */
+    const char *stderr_path;   /* NULL = herdar; criado/truncado */
+    /* redirecionamentos por descritor, aplicados depois dos paths:
+     * dup_from[i] passa a ser dup_to[i] no filho */
+    int dup_from[LAUNCH_MAX_DUPS];
+    int dup_to[LAUNCH_MAX_DUPS];
+    int dup_count;
+} LaunchSpec;
+
+/* Inicializa spec com argv e tudo o resto herdado */
+void launch_spec_init(LaunchSpec *spec, char *const *argv);
+
+/* Adiciona redirecionamento fd -> target_fd; devolve -1 se não houver espaço */
+int launch_spec_dup(LaunchSpec *spec, int fd, int target_fd);
+
+/* Constrói um ambiente = environ com as entradas "NOME=valor" de overrides
+ * sobrepostas. Libertar com launch_env_free(). */
+char **launch_env_build(char *const *overrides);
+void launch_env_free(char **env);
+
+/* Lança um processo; devolve o pid ou -1 (errno indica o erro, incluindo
+ * falhas do exec no filho para LAUNCH_SPAWN/LAUNCH_VFORK). */
+pid_t launch(const LaunchSpec *spec, LaunchMethod method);
+
+/* Lança n processos com no máximo max_inflight em simultâneo e recolhe-os.
+ * statuses (opcional, n posições) recebe o status de waitpid ou -1 se o
+ * lançamento falhou. Devolve o número de processos que não terminaram com 0. */
+int launch_batch(const LaunchSpec *specs, int n, LaunchMethod method, int max_inflight, int *statuses);
+
+const char *launch_method_name(LaunchMethod method);
+int launch_method_parse(const char *name, LaunchMethod *out);
+
+#endif
@@ -0,0 +1,256 @@
+/* pipeline.c
+ *
+ * Executor de pipelines, como "a | b | c" na shell, com medição por etapa.
+ * Todas as etapas são lançadas de uma vez (launcher/launcher.h) e ligadas por
+ * pipes com F_SETPIPE_SZ. Uma etapa de passagem ("=" ou "cat" sem argumentos)
+ * não cria processo: o pai move os dados entre os dois pipes com splice().
+ * As saídas dos filhos são detetadas com pidfd + poll e recolhidas com wait4,
+ * que dá o rusage de cada etapa:
+ *   CPU     = utime + stime
+ *   BLOCKED = tempo de vida da etapa - CPU (à espera de pipe, disco, ...)
+ *
+ * Uso:
+ *   ./pipeline [-p pipe] [-i entrada] [-o saída] etapa1 args '|' etapa2 args '|' ...
+ * onde:
+ *   pipe = tamanho de cada pipe em bytes (default 1 MB)
+ *   sem etapas corre o equivalente a: cat ../exec/exec.c | = | wc
+ *
+ * Compilar:
+ *   gcc pipeline.c ../launcher/launcher.c -o pipeline -O2
+ *
+ * Exemplo:
+ *   ./pipeline -i /var/log/syslog grep error '|' = '|' sort '|' uniq -c
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+
+#include "../launcher/launcher.h"
+
+#define MAX_STAGES 32
+
+typedef struct {
+    char **argv;
+    int passthrough;
+    /* processo */
+    pid_t pid;
+    int pidfd;
+    double started;
+    double finished;
+    struct rusage ru;
+    int status;
+    /* splice no pai */
+    int in_fd;
+    int out_fd;
+    int wait_out;    /* saída cheia: espera POLLOUT em out_fd */
+    long long bytes;
+} Stage;
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static double tv_s(struct timeval tv) {
+    return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+static int is_passthrough(char **argv) {
+    if (strcmp(argv[0], "=") == 0 && argv[1] == NULL) return 1;
+    if (strcmp(argv[0], "cat") == 0 && argv[1] == NULL) return 1;
+    return 0;
+}
+
+/* Divide argv em etapas no token "|" (substituído por NULL) */
+static int split_stages(char **argv, int argc, Stage *stages) {
+    int count = 0;
+    int start = 0;
+    for (int i = 0; i <= argc; ++i) {
+        if (i == argc || strcmp(argv[i], "|") == 0) {
+            if (i == start || count == MAX_STAGES) return -1;
+            argv[i] = NULL;
+            memset(&stages[count], 0, sizeof(Stage));
+            stages[count].argv = &argv[start];
+            stages[count].passthrough = is_passthrough(stages[count].argv);
+            stages[count].in_fd = stages[count].out_fd = stages[count].pidfd = -1;
+            count++;
+            start = i + 1;
+        }
+    }
+    return count;
+}
+
+static int open_pipe(int fds[2], int pipe_size) {
+    if (pipe2(fds, O_CLOEXEC) != 0) return -1;
+    if (fcntl(fds[0], F_SETPIPE_SZ, pipe_size) < 0) perror("F_SETPIPE_SZ");
+    return 0;
+}
+
+/* Lança todas as etapas; devolve -1 se alguma falhou */
+static int launch_stages(Stage *stages, int n, int pipe_size, const char *input, const char *output) {
+    int prev_read = -1; /* -1: stdin herdado/ficheiro de entrada */
+    for (int i = 0; i < n; ++i) {
+        Stage *s = &stages[i];
+        int last = (i == n - 1);
+        int fds[2] = { -1, -1 };
+        if (!last && open_pipe(fds, pipe_size) != 0) { perror("pipe2"); return -1; }
+
+        if (s->passthrough) {
+            s->in_fd = prev_read;
+            if (s->in_fd < 0) s->in_fd = input ? open(input, O_RDONLY | O_CLOEXEC) : dup(STDIN_FILENO);
+            s->out_fd = fds[1];
+            if (last) s->out_fd = output ? open(output, O_CREAT | O_WRONLY | O_TRUNC | O_CLOEXEC, 0644) : dup(STDOUT_FILENO);
+            if (s->in_fd < 0 || s->out_fd < 0) { perror("open"); return -1; }
+        } else {
+            LaunchSpec spec;
+            launch_spec_init(&spec, s->argv);
+            if (prev_read >= 0) launch_spec_dup(&spec, prev_read, STDIN_FILENO);
+            else spec.stdin_path = input;
+            if (!last) launch_spec_dup(&spec, fds[1], STDOUT_FILENO);
+            else spec.stdout_path = output;
+            s->started = now_s();
+            s->pid = launch(&spec, LAUNCH_SPAWN);
+            if (s->pid < 0) {
+                fprintf(stderr, "etapa %d (%s): %s\n", i, s->argv[0], strerror(errno));
+                return -1;
+            }
+            s->pidfd = (int) syscall(SYS_pidfd_open, s->pid, 0);
+            if (prev_read >= 0) close(prev_read);
+            if (fds[1] >= 0) close(fds[1]);
+        }
+        prev_read = fds[0];
+    }
+    return 0;
+}
+
+/* Move dados nas etapas de passagem e regista a hora de saída de cada filho.
+ * O splice não bloqueia: com a saída cheia a etapa passa a esperar POLLOUT
+ * em out_fd, para o ciclo continuar a servir as outras etapas. */
+static void supervise(Stage *stages, int n, int pipe_size) {
+    struct pollfd pfds[MAX_STAGES];
+    int owner[MAX_STAGES];
+    for (;;) {
+        int count = 0;
+        for (int i = 0; i < n; ++i) {
+            Stage *s = &stages[i];
+            int fd = s->passthrough ? s->in_fd : s->pidfd;
+            if (fd < 0) continue;
+            pfds[count].fd = s->passthrough && s->wait_out ? s->out_fd : fd;
+            pfds[count].events = s->passthrough && s->wait_out ? POLLOUT : POLLIN;
+            owner[count++] = i;
+        }
+        if (count == 0) break;
+        if (poll(pfds, count, -1) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        for (int k = 0; k < count; ++k) {
+            if (!pfds[k].revents) continue;
+            Stage *s = &stages[owner[k]];
+            if (s->passthrough) {
+                ssize_t moved = splice(s->in_fd, NULL, s->out_fd, NULL, pipe_size,
+                                       SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+                if (moved > 0) {
+                    s->bytes += moved;
+                    s->wait_out = 0;
+                } else if (moved < 0 && (errno == EAGAIN || errno == EINTR)) {
+                    /* acordou com dados à entrada: é a saída que está cheia;
+                     * acordou com espaço à saída: é a entrada que está vazia */
+                    if (errno == EAGAIN) s->wait_out = !s->wait_out;
+                } else {
+                    /* EOF (ou erro): fecha para propagar o EOF à etapa seguinte */
+                    close(s->in_fd);
+                    close(s->out_fd);
+                    s->in_fd = s->out_fd = -1;
+                }
+            } else {
+                if (wait4(s->pid, &s->status, 0, &s->ru) == s->pid) s->finished = now_s();
+                close(s->pidfd);
+                s->pidfd = -1;
+            }
+        }
+    }
+    /* sem pidfd (kernel antigo): recolhe aqui */
+    for (int i = 0; i < n; ++i) {
+        Stage *s = &stages[i];
+        if (!s->passthrough && s->pid > 0 && s->finished == 0.0) {
+            wait4(s->pid, &s->status, 0, &s->ru);
+            s->finished = now_s();
+        }
+    }
+}
+
+static void print_stages(Stage *stages, int n, double wall) {
+    fprintf(stderr, "\n=== Pipeline (%d etapas, %.3f s) ===\n", n, wall);
+    fprintf(stderr, "%5s | %-12s | %8s | %8s | %8s | %8s | %s\n",
+            "Etapa", "Comando", "Elapsed", "CPU", "BLOCKED", "nvcsw", "status");
+    fprintf(stderr, "--------------------------------------------------------------------------\n");
+    for (int i = 0; i < n; ++i) {
+        Stage *s = &stages[i];
+        if (s->passthrough) {
+            fprintf(stderr, "%5d | %-12s | %8s | %8s | %8s | %8s | splice %lld bytes\n",
+                    i, "=", "-", "-", "-", "-", s->bytes);
+            continue;
+        }
+        double elapsed = s->finished - s->started;
+        double cpu = tv_s(s->ru.ru_utime) + tv_s(s->ru.ru_stime);
+        double blocked = elapsed - cpu;
+        if (blocked < 0.0) blocked = 0.0;
+        char status[32];
+        if (WIFEXITED(s->status)) snprintf(status, sizeof(status), "exit %d", WEXITSTATUS(s->status));
+        else snprintf(status, sizeof(status), "signal %d", WTERMSIG(s->status));
+        fprintf(stderr, "%5d | %-12.12s | %8.3f | %8.3f | %8.3f | %8ld | %s\n",
+                i, s->argv[0], elapsed, cpu, blocked, s->ru.ru_nvcsw, status);
+    }
+    fprintf(stderr, "--------------------------------------------------------------------------\n");
+}
+
+int main(int argc, char *argv[]) {
+    int pipe_size = 1 << 20;
+    const char *input = NULL, *output = NULL;
+    char *default_args[] = { "cat", "../exec/exec.c", "|", "=", "|", "wc", NULL };
+
+    int i = 1;
+    for (; i < argc && argv[i][0] == '-' && argv[i][1] != '\0'; ++i) {
+        if (strcmp(argv[i], "-p") == 0 && i + 1 < argc) {
+            pipe_size = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-i") == 0 && i + 1 < argc) {
+            input = argv[++i];
+        } else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            output = argv[++i];
+        } else {
+            fprintf(stderr, "usage: pipeline [-p pipe] [-i entrada] [-o saída] etapa args '|' etapa args ...\n");
+            return 1;
+        }
+    }
+    if (pipe_size < 4096) pipe_size = 4096;
+    char **args = (i < argc) ? &argv[i] : default_args;
+    int nargs = (i < argc) ? argc - i : 6;
+
+    Stage stages[MAX_STAGES];
+    int n = split_stages(args, nargs, stages);
+    if (n <= 0) {
+        fprintf(stderr, "Pipeline inválido (etapa vazia ou mais de %d etapas)\n", MAX_STAGES);
+        return 1;
+    }
+
+    double t0 = now_s();
+    int rc = launch_stages(stages, n, pipe_size, input, output);
+    supervise(stages, n, pipe_size);
+    print_stages(stages, n, now_s() - t0);
+    if (rc != 0) return 1;
+    Stage *last = &stages[n - 1];
+    if (!last->passthrough && (!WIFEXITED(last->status) || WEXITSTATUS(last->status) != 0)) return 1;
+    return 0;
+}
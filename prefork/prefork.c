@@ -0,0 +1,333 @@
+/* prefork.c
+ *
+ * Modelo prefork: o mestre faz fork de W workers uma única vez e estes
+ * retiram jobs de um anel lock-free (MPMC, números de sequência por célula)
+ * em memória MAP_SHARED|MAP_ANONYMOUS. Um semáforo partilhado (sem_t com
+ * pshared=1, futex) adormece os workers quando o anel está vazio.
+ *
+ * Supervisão à base de wait (como em wait/wait.c): o mestre recolhe os
+ * workers com waitpid; se um worker morrer a meio de um job, o job é
+ * reposto no anel (até MAX_ATTEMPTS tentativas) e o worker é substituído.
+ * No fim o mestre põe um job "STOP" por worker e espera que todos saiam.
+ *
+ * Compara com fork-por-job (um fork por job, no máximo W em simultâneo).
+ *
+ * Uso:
+ *   ./prefork [-w W] [-n jobs] [-i iterações] [-c prob]
+ * onde:
+ *   W          = número de workers (default 4)
+ *   jobs       = número de jobs (default 100000)
+ *   iterações  = trabalho de CPU por job (default 2000)
+ *   prob       = probabilidade de um worker rebentar num job (default 0)
+ *
+ * Compilar:
+ *   gcc prefork.c -o prefork -O2 -pthread
+ *
+ * Exemplo:
+ *   ./prefork -w 8 -n 200000 -c 0.0001
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <errno.h>
+#include <sched.h>
+#include <semaphore.h>
+#include <signal.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+
+#define RING_SIZE 4096          /* potência de 2 */
+#define MAX_WORKERS 256
+#define MAX_ATTEMPTS 3
+#define JOB_STOP (-1)
+#define NO_JOB (-2)
+
+typedef struct {
+    int64_t id;       /* JOB_STOP termina o worker */
+    int attempts;
+} Job;
+
+typedef struct {
+    atomic_size_t seq;
+    Job job;
+} Cell;
+
+/* Tudo o que vive em memória partilhada */
+typedef struct {
+    atomic_size_t enqueue_pos;
+    char pad1[64 - sizeof(atomic_size_t)];
+    atomic_size_t dequeue_pos;
+    char pad2[64 - sizeof(atomic_size_t)];
+    sem_t items;
+    atomic_long completed;
+    atomic_long failed;
+    atomic_ulong checksum;
+    Job current[MAX_WORKERS];   /* job em curso por slot de worker */
+    Cell cells[RING_SIZE];
+} Shared;
+
+static Shared *shm;
+static long iterations = 2000;
+static double crash_prob = 0.0;
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* ------------------- Anel MPMC ------------------- */
+
+static void ring_init(void) {
+    for (size_t i = 0; i < RING_SIZE; ++i) atomic_init(&shm->cells[i].seq, i);
+    atomic_init(&shm->enqueue_pos, 0);
+    atomic_init(&shm->dequeue_pos, 0);
+}
+
+static int ring_push(Job job) {
+    size_t pos = atomic_load_explicit(&shm->enqueue_pos, memory_order_relaxed);
+    for (;;) {
+        Cell *cell = &shm->cells[pos & (RING_SIZE - 1)];
+        size_t seq = atomic_load_explicit(&cell->seq, memory_order_acquire);
+        intptr_t diff = (intptr_t) seq - (intptr_t) pos;
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&shm->enqueue_pos, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                cell->job = job;
+                atomic_store_explicit(&cell->seq, pos + 1, memory_order_release);
+                return 0;
+            }
+        } else if (diff < 0) {
+            return -1; /* cheio */
+        } else {
+            pos = atomic_load_explicit(&shm->enqueue_pos, memory_order_relaxed);
+        }
+    }
+}
+
+static int ring_pop(Job *out) {
+    size_t pos = atomic_load_explicit(&shm->dequeue_pos, memory_order_relaxed);
+    for (;;) {
+        Cell *cell = &shm->cells[pos & (RING_SIZE - 1)];
+        size_t seq = atomic_load_explicit(&cell->seq, memory_order_acquire);
+        intptr_t diff = (intptr_t) seq - (intptr_t) (pos + 1);
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&shm->dequeue_pos, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                *out = cell->job;
+                atomic_store_explicit(&cell->seq, pos + RING_SIZE, memory_order_release);
+                return 0;
+            }
+        } else if (diff < 0) {
+            return -1; /* vazio */
+        } else {
+            pos = atomic_load_explicit(&shm->dequeue_pos, memory_order_relaxed);
+        }
+    }
+}
+
+/* ------------------- Trabalho ------------------- */
+
+static uint64_t do_job(int64_t id) {
+    uint64_t x = (uint64_t) id * 0x9E3779B97F4A7C15ULL + 1;
+    for (long i = 0; i < iterations; ++i) {
+        x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+    }
+    return x;
+}
+
+static int should_crash(int64_t id, int attempts) {
+    if (crash_prob <= 0.0 || attempts > 0) return 0;
+    uint64_t h = (uint64_t) id * 0xD1B54A32D192ED03ULL;
+    return (double) (h >> 11) / (double) (1ULL << 53) < crash_prob;
+}
+
+static void worker_main(int slot) {
+    for (;;) {
+        Job job;
+        while (sem_wait(&shm->items) != 0 && errno == EINTR) { }
+        while (ring_pop(&job) != 0) sched_yield(); /* o push precede o post */
+        if (job.id == JOB_STOP) _exit(0);
+        shm->current[slot] = job;
+        if (should_crash(job.id, job.attempts)) abort();
+        atomic_fetch_add(&shm->checksum, do_job(job.id));
+        shm->current[slot].id = NO_JOB;
+        atomic_fetch_add(&shm->completed, 1);
+    }
+}
+
+/* ------------------- Mestre ------------------- */
+
+static pid_t worker_pids[MAX_WORKERS];
+static int nworkers;
+static int alive;
+static long crashes;
+
+static void spawn_worker(int slot) {
+    shm->current[slot].id = NO_JOB;
+    pid_t rc = fork();
+    if (rc < 0) {
+        fprintf(stderr, "fork failed\n");
+        exit(1);
+    } else if (rc == 0) {
+        worker_main(slot);
+    }
+    worker_pids[slot] = rc;
+    alive++;
+}
+
+static void push_job(Job job);
+
+/* Trata a saída de um worker; devolve 1 se foi uma saída normal (STOP) */
+static int handle_exit(pid_t pid, int status) {
+    int slot = -1;
+    for (int i = 0; i < nworkers; ++i) if (worker_pids[i] == pid) { slot = i; break; }
+    if (slot < 0) return 0;
+    worker_pids[slot] = 0;
+    alive--;
+    if (WIFEXITED(status) && WEXITSTATUS(status) == 0) return 1;
+
+    /* crash: repõe o job em curso e substitui o worker */
+    crashes++;
+    Job lost = shm->current[slot];
+    spawn_worker(slot);
+    if (lost.id >= 0) {
+        lost.attempts++;
+        if (lost.attempts >= MAX_ATTEMPTS) atomic_fetch_add(&shm->failed, 1);
+        else push_job(lost);
+    }
+    return 0;
+}
+
+static void reap_nonblocking(void) {
+    int status;
+    pid_t pid;
+    while ((pid = waitpid(-1, &status, WNOHANG)) > 0) handle_exit(pid, status);
+}
+
+static void push_job(Job job) {
+    while (ring_push(job) != 0) {
+        reap_nonblocking();
+        sched_yield();
+    }
+    sem_post(&shm->items);
+}
+
+static double run_prefork(int w, long n) {
+    nworkers = w;
+    alive = 0;
+    crashes = 0;
+    ring_init();
+    sem_init(&shm->items, 1, 0);
+    atomic_store(&shm->completed, 0);
+    atomic_store(&shm->failed, 0);
+    atomic_store(&shm->checksum, 0);
+
+    double t0 = now_s();
+    for (int i = 0; i < w; ++i) spawn_worker(i);
+    for (long j = 0; j < n; ++j) push_job((Job) { j, 0 });
+    for (int i = 0; i < w; ++i) push_job((Job) { JOB_STOP, 0 });
+
+    /* supervisão: bloqueia em waitpid até todos os workers saírem */
+    while (alive > 0) {
+        int status;
+        pid_t pid = waitpid(-1, &status, 0);
+        if (pid < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        int normal = handle_exit(pid, status);
+        long outstanding = n - atomic_load(&shm->completed) - atomic_load(&shm->failed);
+        if (normal && outstanding > 0) {
+            /* jobs repostos ficaram atrás dos STOP: precisa de mais um worker */
+            for (int i = 0; i < nworkers; ++i) {
+                if (worker_pids[i] == 0) { spawn_worker(i); break; }
+            }
+            push_job((Job) { JOB_STOP, 0 });
+        }
+    }
+    double elapsed = now_s() - t0;
+    sem_destroy(&shm->items);
+    return elapsed;
+}
+
+static double run_fork_per_job(int w, long n) {
+    long started = 0, running = 0;
+    crashes = 0;
+    atomic_store(&shm->completed, 0);
+    atomic_store(&shm->failed, 0);
+    atomic_store(&shm->checksum, 0);
+    double t0 = now_s();
+    while (started < n || running > 0) {
+        while (started < n && running < w) {
+            int64_t id = started++;
+            pid_t rc = fork();
+            if (rc < 0) {
+                fprintf(stderr, "fork failed\n");
+                exit(1);
+            } else if (rc == 0) {
+                if (should_crash(id, 0)) abort();
+                atomic_fetch_add(&shm->checksum, do_job(id));
+                atomic_fetch_add(&shm->completed, 1);
+                _exit(0);
+            }
+            running++;
+        }
+        int status;
+        if (wait(&status) > 0) {
+            running--;
+            if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+                crashes++;
+                atomic_fetch_add(&shm->failed, 1);
+            }
+        }
+    }
+    return now_s() - t0;
+}
+
+int main(int argc, char *argv[]) {
+    int w = 4;
+    long n = 100000;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "-w") == 0 && i + 1 < argc) {
+            w = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            n = atol(argv[++i]);
+        } else if (strcmp(argv[i], "-i") == 0 && i + 1 < argc) {
+            iterations = atol(argv[++i]);
+        } else if (strcmp(argv[i], "-c") == 0 && i + 1 < argc) {
+            crash_prob = atof(argv[++i]);
+        } else {
+            fprintf(stderr, "usage: prefork [-w W] [-n jobs] [-i iterações] [-c prob]\n");
+            return 1;
+        }
+    }
+    if (w < 1) w = 1;
+    if (w > MAX_WORKERS) w = MAX_WORKERS;
+    if (n < 1) n = 1;
+
+    shm = (Shared*) mmap(NULL, sizeof(Shared), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (shm == MAP_FAILED) {
+        perror("mmap");
+        return 1;
+    }
+
+    printf("workers: %d, jobs: %ld, iterações/job: %ld, prob. crash: %g\n", w, n, iterations, crash_prob);
+    printf("%-13s | %9s | %7s | %7s | %8s | %10s\n", "Modelo", "Completos", "Falhas", "Crashes", "tempo s", "jobs/s");
+    printf("--------------------------------------------------------------------\n");
+    double t = run_prefork(w, n);
+    printf("%-13s | %9ld | %7ld | %7ld | %8.3f | %10.0f\n", "prefork",
+           atomic_load(&shm->completed), atomic_load(&shm->failed), crashes, t, n / t);
+    t = run_fork_per_job(w, n);
+    printf("%-13s | %9ld | %7ld | %7ld | %8.3f | %10.0f\n", "fork-por-job",
+           atomic_load(&shm->completed), atomic_load(&shm->failed), crashes, t, n / t);
+    printf("--------------------------------------------------------------------\n");
+    munmap(shm, sizeof(Shared));
+    return 0;
+}
@@ -0,0 +1,395 @@
+/* reaper.c
+ *
+ * Reaper orientado a eventos para milhares de filhos: um pidfd por filho
+ * (pidfd_open) registado em epoll, juntamente com um único timerfd armado
+ * para o timeout mais próximo (min-heap de deadlines). As saídas são
+ * recolhidas com waitid(P_PIDFD) e o rusage completo de cada filho.
+ * Filhos que excedam o timeout são mortos com pidfd_send_signal(SIGKILL).
+ *
+ * Compara com os ciclos clássicos de wait/wait.c:
+ *   wait    : while (wait(NULL) > 0)
+ *   waitpid : while (waitpid(-1, &status, 0) > 0)
+ *   pidfd   : epoll + pidfd + timerfd (único modo com timeouts)
+ *
+ * Cada filho dorme um tempo aleatório e regista, em memória partilhada, o
+ * instante em que sai; a latência de recolha é o tempo até o pai o recolher.
+ * O custo de CPU é o rusage do pai durante a recolha.
+ *
+ * Uso:
+ *   ./reaper [-n N[,N...]] [-s ms] [-t ms] [modo...]
+ * onde:
+ *   N  = número de filhos (default 10,100,1000,10000)
+ *   -s = tempo máximo que cada filho dorme (default 200 ms)
+ *   -t = timeout por filho no modo pidfd (default 0 = sem timeout)
+ * O modo pidfd usa um descritor por filho: o limite soft de RLIMIT_NOFILE
+ * sobe até ao hard e, se mesmo assim não chegar para N, o modo é ignorado.
+ * Um modo que não consiga criar os N filhos é abortado, sem linha parcial.
+ *
+ * Compilar:
+ *   gcc reaper.c -o reaper -O2
+ *
+ * Exemplo:
+ *   ./reaper -n 1000 -s 100 -t 80 pidfd
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/epoll.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <sys/timerfd.h>
+#include <sys/wait.h>
+
+#ifndef P_PIDFD
+#define P_PIDFD 3
+#endif
+
+#define MAX_SIZES 8
+#define MAX_EVENTS 256
+#define FD_RESERVE 16   /* stdio, pipe de arranque, epoll e timerfd */
+
+typedef enum { MODE_WAIT, MODE_WAITPID, MODE_PIDFD, N_MODE } Mode;
+
+static const char *mode_names[N_MODE] = { "wait", "waitpid", "pidfd" };
+
+/* Estado de cada filho no modo pidfd */
+typedef struct {
+    pid_t pid;
+    int pidfd;     /* -1 depois de recolhido */
+    double deadline;
+} Child;
+
+/* min-heap de índices de filhos ordenado por deadline */
+typedef struct {
+    int *items;
+    int size;
+} Heap;
+
+static double *exit_stamps; /* MAP_SHARED: escrito pelos filhos */
+
+static double now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static double cpu_ms(void) {
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+    return (ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) * 1e3
+         + (ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) / 1e3;
+}
+
+/* ------------------- Heap ------------------- */
+
+static void heap_push(Heap *h, Child *children, int idx) {
+    int i = h->size++;
+    h->items[i] = idx;
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (children[h->items[parent]].deadline <= children[h->items[i]].deadline) break;
+        int tmp = h->items[parent]; h->items[parent] = h->items[i]; h->items[i] = tmp;
+        i = parent;
+    }
+}
+
+static int heap_pop(Heap *h, Child *children) {
+    int top = h->items[0];
+    h->items[0] = h->items[--h->size];
+    int i = 0;
+    for (;;) {
+        int l = 2 * i + 1, r = l + 1, m = i;
+        if (l < h->size && children[h->items[l]].deadline < children[h->items[m]].deadline) m = l;
+        if (r < h->size && children[h->items[r]].deadline < children[h->items[m]].deadline) m = r;
+        if (m == i) break;
+        int tmp = h->items[m]; h->items[m] = h->items[i]; h->items[i] = tmp;
+        i = m;
+    }
+    return top;
+}
+
+/* ------------------- Filhos ------------------- */
+
+/* O filho espera pelo EOF em start[0], para que todos comecem a dormir
+ * ao mesmo tempo depois de criados, e só então conta o seu sono */
+static pid_t spawn_child(int idx, int sleep_ms, int start[2]) {
+    int ms = sleep_ms > 0 ? rand() % sleep_ms : 0;
+    pid_t rc = fork();
+    if (rc == 0) {
+        char c;
+        close(start[1]);
+        while (read(start[0], &c, 1) < 0 && errno == EINTR) { }
+        struct timespec ts = { ms / 1000, (ms % 1000) * 1000000L };
+        nanosleep(&ts, NULL);
+        exit_stamps[idx] = now_us();
+        _exit(0);
+    }
+    return rc;
+}
+
+static void arm_timer(int tfd, double deadline_us) {
+    struct itimerspec its;
+    memset(&its, 0, sizeof(its));
+    /* tempo absoluto em CLOCK_MONOTONIC, como now_us() */
+    its.it_value.tv_sec = (time_t) (deadline_us / 1e6);
+    its.it_value.tv_nsec = (long) ((deadline_us - its.it_value.tv_sec * 1e6) * 1e3);
+    if (its.it_value.tv_sec == 0 && its.it_value.tv_nsec == 0) its.it_value.tv_nsec = 1;
+    timerfd_settime(tfd, TFD_TIMER_ABSTIME, &its, NULL);
+}
+
+/* ------------------- Modos ------------------- */
+
+typedef struct {
+    pid_t pid;
+    int index;
+} PidIndex;
+
+static int cmp_pid(const void *a, const void *b) {
+    pid_t x = ((const PidIndex*) a)->pid, y = ((const PidIndex*) b)->pid;
+    return (x > y) - (x < y);
+}
+
+/* Devolve o número de filhos recolhidos; preenche reap_stamps por índice.
+ * pid -> índice por pesquisa binária, para não penalizar os ciclos clássicos */
+static int reap_classic(Mode mode, pid_t *pids, int n, double *reap_stamps) {
+    PidIndex *map = (PidIndex*) malloc(sizeof(PidIndex) * n);
+    for (int i = 0; i < n; ++i) map[i] = (PidIndex) { pids[i], i };
+    qsort(map, n, sizeof(PidIndex), cmp_pid);
+    int reaped = 0;
+    while (reaped < n) {
+        int status;
+        pid_t done = (mode == MODE_WAIT) ? wait(NULL) : waitpid(-1, &status, 0);
+        if (done < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        double t = now_us();
+        PidIndex key = { done, 0 };
+        PidIndex *hit = (PidIndex*) bsearch(&key, map, n, sizeof(PidIndex), cmp_pid);
+        if (hit) reap_stamps[hit->index] = t;
+        reaped++;
+    }
+    free(map);
+    return reaped;
+}
+
+static int reap_pidfd(Child *children, int n, double timeout_ms, double *reap_stamps, int *killed) {
+    int epfd = epoll_create1(EPOLL_CLOEXEC);
+    int tfd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK);
+    Heap heap = { (int*) malloc(sizeof(int) * n), 0 };
+    struct epoll_event ev = { .events = EPOLLIN, .data.u32 = (uint32_t) n }; /* n = timer */
+    epoll_ctl(epfd, EPOLL_CTL_ADD, tfd, &ev);
+    for (int i = 0; i < n; ++i) {
+        ev.data.u32 = (uint32_t) i;
+        epoll_ctl(epfd, EPOLL_CTL_ADD, children[i].pidfd, &ev);
+        if (timeout_ms > 0) heap_push(&heap, children, i);
+    }
+    if (heap.size > 0) arm_timer(tfd, children[heap.items[0]].deadline);
+
+    int reaped = 0;
+    *killed = 0;
+    struct epoll_event events[MAX_EVENTS];
+    while (reaped < n) {
+        int ready = epoll_wait(epfd, events, MAX_EVENTS, -1);
+        if (ready < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        double t = now_us();
+        for (int e = 0; e < ready; ++e) {
+            uint32_t idx = events[e].data.u32;
+            if (idx == (uint32_t) n) {
+                /* timeout(s): mata todos os filhos com deadline vencido */
+                uint64_t expirations;
+                if (read(tfd, &expirations, sizeof(expirations)) < 0) { /* já lido */ }
+                while (heap.size > 0 && children[heap.items[0]].deadline <= t) {
+                    int victim = heap_pop(&heap, children);
+                    if (children[victim].pidfd >= 0) {
+                        syscall(SYS_pidfd_send_signal, children[victim].pidfd, SIGKILL, NULL, 0);
+                        (*killed)++;
+                    }
+                }
+                if (heap.size > 0) arm_timer(tfd, children[heap.items[0]].deadline);
+                continue;
+            }
+            Child *c = &children[idx];
+            siginfo_t info;
+            struct rusage ru;
+            memset(&info, 0, sizeof(info));
+            if (syscall(SYS_waitid, P_PIDFD, c->pidfd, &info, WEXITED, &ru) != 0) continue;
+            reap_stamps[idx] = t;
+            epoll_ctl(epfd, EPOLL_CTL_DEL, c->pidfd, NULL);
+            close(c->pidfd);
+            c->pidfd = -1; /* fica no heap; ignorado quando o deadline vencer */
+            reaped++;
+        }
+    }
+    free(heap.items);
+    close(tfd);
+    close(epfd);
+    return reaped;
+}
+
+/* ------------------- Benchmark ------------------- */
+
+static int cmp_double(const void *a, const void *b) {
+    double x = *(const double*) a, y = *(const double*) b;
+    return (x > y) - (x < y);
+}
+
+/* O modo pidfd precisa de um descritor por filho: sobe o limite soft até
+ * ao hard logo no arranque */
+static void raise_nofile(void) {
+    struct rlimit rl;
+    if (getrlimit(RLIMIT_NOFILE, &rl) == 0 && rl.rlim_cur < rl.rlim_max) {
+        rl.rlim_cur = rl.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &rl);
+    }
+}
+
+/* Mata e recolhe os filhos já criados quando o modo não pode continuar */
+static void abort_children(pid_t *pids, Child *children, int alive, int start[2]) {
+    for (int i = 0; i < alive; ++i) {
+        kill(pids[i], SIGKILL);
+        if (children[i].pidfd >= 0) close(children[i].pidfd);
+    }
+    close(start[0]);
+    close(start[1]);
+    while (waitpid(-1, NULL, 0) > 0) { }
+}
+
+static void run_mode(Mode mode, int n, int sleep_ms, double timeout_ms) {
+    if (mode == MODE_PIDFD) {
+        struct rlimit rl;
+        if (getrlimit(RLIMIT_NOFILE, &rl) == 0 && rl.rlim_cur != RLIM_INFINITY && rl.rlim_cur < (rlim_t) n + FD_RESERVE) {
+            fflush(stdout);
+            fprintf(stderr, "pidfd: %d filhos precisam de %d descritores, RLIMIT_NOFILE é %llu; modo ignorado\n",
+                    n, n + FD_RESERVE, (unsigned long long) rl.rlim_cur);
+            return;
+        }
+    }
+    pid_t *pids = (pid_t*) malloc(sizeof(pid_t) * n);
+    Child *children = (Child*) malloc(sizeof(Child) * n);
+    double *reap_stamps = (double*) malloc(sizeof(double) * n);
+    double *latency = (double*) malloc(sizeof(double) * n);
+    int spawned = 0, killed = 0;
+    int start[2];
+    if (pipe(start) != 0) { perror("pipe"); exit(1); }
+
+    for (int i = 0; i < n; ++i) {
+        exit_stamps[i] = 0.0;
+        reap_stamps[i] = 0.0;
+        pids[i] = spawn_child(i, sleep_ms, start);
+        if (pids[i] < 0) {
+            fprintf(stderr, "%s: fork failed depois de %d filhos; modo abortado\n", mode_names[mode], i);
+            break;
+        }
+        children[i].pid = pids[i];
+        children[i].pidfd = (mode == MODE_PIDFD) ? (int) syscall(SYS_pidfd_open, pids[i], 0) : -1;
+        spawned++;
+        if (mode == MODE_PIDFD && children[i].pidfd < 0) {
+            fprintf(stderr, "%s: pidfd_open falhou depois de %d filhos (%s); modo abortado\n",
+                    mode_names[mode], i, strerror(errno));
+            break;
+        }
+    }
+    if (spawned < n || (mode == MODE_PIDFD && spawned > 0 && children[spawned - 1].pidfd < 0)) {
+        /* sem linha parcial: não seria comparável com as dos outros modos */
+        abort_children(pids, children, spawned, start);
+        free(pids);
+        free(children);
+        free(reap_stamps);
+        free(latency);
+        return;
+    }
+    close(start[0]);
+    double go = now_us();
+    for (int i = 0; i < spawned; ++i) children[i].deadline = go + timeout_ms * 1e3;
+    close(start[1]); /* EOF: todos os filhos começam agora */
+
+    double cpu0 = cpu_ms();
+    double t0 = now_us();
+    int reaped = (mode == MODE_PIDFD)
+        ? reap_pidfd(children, spawned, timeout_ms, reap_stamps, &killed)
+        : reap_classic(mode, pids, spawned, reap_stamps);
+    double wall_ms = (now_us() - t0) / 1e3;
+    double cpu = cpu_ms() - cpu0;
+    while (waitpid(-1, NULL, 0) > 0) { /* filhos que sobraram de uma falha */ }
+
+    int count = 0;
+    for (int i = 0; i < spawned; ++i) {
+        if (exit_stamps[i] > 0.0 && reap_stamps[i] > 0.0) latency[count++] = reap_stamps[i] - exit_stamps[i];
+    }
+    qsort(latency, count, sizeof(double), cmp_double);
+    double p50 = count ? latency[count / 2] : 0.0;
+    double p99 = count ? latency[(int) (0.99 * (count - 1))] : 0.0;
+    double max = count ? latency[count - 1] : 0.0;
+    printf("%-7s | %6d | %6d | %6d | %8.1f | %8.1f | %8.1f | %8.2f | %8.1f\n",
+           mode_names[mode], spawned, reaped, killed, p50, p99, max, cpu, wall_ms);
+
+    free(pids);
+    free(children);
+    free(reap_stamps);
+    free(latency);
+}
+
+int main(int argc, char *argv[]) {
+    int sizes[MAX_SIZES] = { 10, 100, 1000, 10000 };
+    int size_count = 4;
+    int sleep_ms = 200;
+    double timeout_ms = 0.0;
+    int selected[N_MODE] = { 0 };
+    int any_selected = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            size_count = 0;
+            char *copy = strdup(argv[++i]);
+            for (char *tok = strtok(copy, ","); tok && size_count < MAX_SIZES; tok = strtok(NULL, ","))
+                sizes[size_count++] = atoi(tok);
+            free(copy);
+        } else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            sleep_ms = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+            timeout_ms = atof(argv[++i]);
+        } else {
+            int found = 0;
+            for (int m = 0; m < N_MODE; ++m) {
+                if (strcmp(argv[i], mode_names[m]) == 0) { selected[m] = 1; found = 1; }
+            }
+            if (!found) {
+                fprintf(stderr, "usage: reaper [-n N[,N...]] [-s ms] [-t ms] [wait|waitpid|pidfd...]\n");
+                return 1;
+            }
+            any_selected = 1;
+        }
+    }
+    if (!any_selected) for (int m = 0; m < N_MODE; ++m) selected[m] = 1;
+    raise_nofile();
+
+    int max_n = 0;
+    for (int s = 0; s < size_count; ++s) if (sizes[s] > max_n) max_n = sizes[s];
+    exit_stamps = (double*) mmap(NULL, sizeof(double) * (max_n + 1), PROT_READ | PROT_WRITE,
+                                 MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (exit_stamps == MAP_FAILED) { perror("mmap"); return 1; }
+    srand(1234);
+
+    printf("sono máximo por filho: %d ms, timeout: %.0f ms (latências em us)\n", sleep_ms, timeout_ms);
+    printf("%-7s | %6s | %6s | %6s | %8s | %8s | %8s | %8s | %8s\n",
+           "Modo", "Filhos", "Recolh", "Mortos", "lat p50", "lat p99", "lat max", "CPU ms", "wall ms");
+    printf("----------------------------------------------------------------------------------------\n");
+    for (int s = 0; s < size_count; ++s) {
+        for (int m = 0; m < N_MODE; ++m) {
+            if (selected[m]) run_mode((Mode) m, sizes[s], sleep_ms, timeout_ms);
+        }
+    }
+    printf("----------------------------------------------------------------------------------------\n");
+    return 0;
+}
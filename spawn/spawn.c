@@ -0,0 +1,264 @@
+/* spawn.c
+ *
+ * Benchmark de criação de processos/threads.
+ * Cria e recolhe N filhos (ou threads) com cada mecanismo:
+ *   fork-exit   : fork() + _exit() no filho
+ *   fork-exec   : fork() + execv("/bin/true")
+ *   vfork-exec  : vfork() + execv("/bin/true")
+ *   clone-vm    : clone(CLONE_VM) + return no filho
+ *   posix-spawn : posix_spawn("/bin/true")
+ *   pthread     : pthread_create() + pthread_join()
+ *
+ * Para cada tamanho de RSS do pai (memória alocada e tocada antes do teste)
+ * imprime latência por spawn (p50/p90/p99/max, em microsegundos) e spawns/s.
+ * "spawn" mede até a chamada regressar no pai; "total" inclui o wait/join.
+ *
+ * Uso:
+ *   ./spawn [-n N] [-m MB[,MB...]] [mecanismo...]
+ * onde:
+ *   N  = número de spawns por mecanismo (default 1000)
+ *   MB = tamanhos de RSS do pai em MB (default 1,64,1024; máx. 8192)
+ *
+ * Compilar:
+ *   gcc spawn.c -o spawn -O2 -pthread
+ *
+ * Exemplo:
+ *   ./spawn -n 500 -m 1,1024,8192 fork-exec posix-spawn
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sched.h>
+#include <signal.h>
+#include <spawn.h>
+#include <pthread.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+
+#define TARGET "/bin/true"
+#define CLONE_STACK (64 * 1024)
+#define MAX_SIZES 16
+
+extern char **environ;
+
+typedef int (*spawn_fn)(void);
+
+static char *clone_stack;
+
+static double now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+/* ------------------- Mecanismos ------------------- */
+/* Cada função cria um filho e devolve o pid (ou -1). A recolha é feita
+ * por reap_child(), exceto pthread que faz join dentro de spawn_pthread. */
+
+static int spawn_fork_exit(void) {
+    pid_t rc = fork();
+    if (rc == 0) _exit(0);
+    return rc;
+}
+
+static int spawn_fork_exec(void) {
+    pid_t rc = fork();
+    if (rc == 0) {
+        char *args[] = { TARGET, NULL };
+        execv(args[0], args);
+        _exit(127);
+    }
+    return rc;
+}
+
+static int spawn_vfork_exec(void) {
+    pid_t rc = vfork();
+    if (rc == 0) {
+        char *args[] = { TARGET, NULL };
+        execv(args[0], args);
+        _exit(127);
+    }
+    return rc;
+}
+
+static int clone_child(void *arg) {
+    (void) arg;
+    return 0;
+}
+
+static int spawn_clone_vm(void) {
+    return clone(clone_child, clone_stack + CLONE_STACK, CLONE_VM | SIGCHLD, NULL);
+}
+
+static int spawn_posix_spawn(void) {
+    pid_t pid;
+    char *args[] = { TARGET, NULL };
+    if (posix_spawn(&pid, TARGET, NULL, NULL, args, environ) != 0) return -1;
+    return pid;
+}
+
+static void *thread_body(void *arg) {
+    return arg;
+}
+
+static pthread_t last_thread;
+
+static int spawn_pthread(void) {
+    return pthread_create(&last_thread, NULL, thread_body, NULL) == 0 ? 0 : -1;
+}
+
+static int reap_child(int pid, int is_thread) {
+    if (is_thread) return pthread_join(last_thread, NULL);
+    int status;
+    if (waitpid(pid, &status, 0) != pid) return -1;
+    return (WIFEXITED(status) && WEXITSTATUS(status) == 0) ? 0 : -1;
+}
+
+typedef struct {
+    const char *name;
+    spawn_fn fn;
+    int is_thread;
+} Mechanism;
+
+static const Mechanism mechanisms[] = {
+    { "fork-exit",   spawn_fork_exit,   0 },
+    { "fork-exec",   spawn_fork_exec,   0 },
+    { "vfork-exec",  spawn_vfork_exec,  0 },
+    { "clone-vm",    spawn_clone_vm,    0 },
+    { "posix-spawn", spawn_posix_spawn, 0 },
+    { "pthread",     spawn_pthread,     1 },
+};
+#define N_MECH ((int) (sizeof(mechanisms) / sizeof(mechanisms[0])))
+
+/* ------------------- Estatística ------------------- */
+
+static int cmp_double(const void *a, const void *b) {
+    double x = *(const double*) a, y = *(const double*) b;
+    return (x > y) - (x < y);
+}
+
+static double percentile(double *sorted, int n, double p) {
+    int idx = (int) (p * (n - 1) + 0.5);
+    return sorted[idx];
+}
+
+/* ------------------- Benchmark ------------------- */
+
+static int run_mechanism(const Mechanism *m, int n, size_t rss_mb) {
+    double *spawn_lat = (double*) malloc(sizeof(double) * n);
+    double *total_lat = (double*) malloc(sizeof(double) * n);
+    int failed = 0;
+
+    double start = now_us();
+    for (int i = 0; i < n; ++i) {
+        double t0 = now_us();
+        int pid = m->fn();
+        double t1 = now_us();
+        if (pid < 0 || reap_child(pid, m->is_thread) != 0) {
+            failed = 1;
+            break;
+        }
+        double t2 = now_us();
+        spawn_lat[i] = t1 - t0;
+        total_lat[i] = t2 - t0;
+    }
+    double elapsed = now_us() - start;
+
+    if (failed) {
+        fprintf(stderr, "%s falhou (rss %zu MB)\n", m->name, rss_mb);
+    } else {
+        qsort(spawn_lat, n, sizeof(double), cmp_double);
+        qsort(total_lat, n, sizeof(double), cmp_double);
+        printf("%6zu | %-11s | %8.1f | %8.1f | %8.1f | %8.1f | %9.1f | %10.0f\n",
+               rss_mb, m->name,
+               percentile(spawn_lat, n, 0.50), percentile(total_lat, n, 0.50),
+               percentile(total_lat, n, 0.90), percentile(total_lat, n, 0.99),
+               total_lat[n - 1], n / (elapsed / 1e6));
+    }
+    free(spawn_lat);
+    free(total_lat);
+    return failed ? -1 : 0;
+}
+
+/* Aloca e toca rss_mb MB para que as tabelas de páginas do pai tenham esse tamanho */
+static void *inflate_rss(size_t rss_mb) {
+    size_t bytes = rss_mb << 20;
+    void *mem = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mem == MAP_FAILED) return NULL;
+    long page = sysconf(_SC_PAGESIZE);
+    for (size_t off = 0; off < bytes; off += page) ((char*) mem)[off] = 1;
+    return mem;
+}
+
+static int parse_sizes(const char *arg, size_t *sizes) {
+    int count = 0;
+    char *copy = strdup(arg);
+    for (char *tok = strtok(copy, ","); tok && count < MAX_SIZES; tok = strtok(NULL, ",")) {
+        long mb = atol(tok);
+        if (mb < 1 || mb > 8192) {
+            fprintf(stderr, "Tamanho inválido: %s (1..8192 MB)\n", tok);
+            free(copy);
+            return -1;
+        }
+        sizes[count++] = (size_t) mb;
+    }
+    free(copy);
+    return count;
+}
+
+int main(int argc, char *argv[]) {
+    int n = 1000;
+    size_t sizes[MAX_SIZES] = { 1, 64, 1024 };
+    int size_count = 3;
+    int selected[N_MECH];
+    int any_selected = 0;
+    memset(selected, 0, sizeof(selected));
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            n = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-m") == 0 && i + 1 < argc) {
+            size_count = parse_sizes(argv[++i], sizes);
+            if (size_count <= 0) return 1;
+        } else {
+            int found = 0;
+            for (int j = 0; j < N_MECH; ++j) {
+                if (strcmp(argv[i], mechanisms[j].name) == 0) { selected[j] = 1; found = 1; }
+            }
+            if (!found) {
+                fprintf(stderr, "usage: spawn [-n N] [-m MB[,MB...]] [mecanismo...]\n");
+                fprintf(stderr, " mecanismo = fork-exit | fork-exec | vfork-exec | clone-vm | posix-spawn | pthread\n");
+                return 1;
+            }
+            any_selected = 1;
+        }
+    }
+    if (n < 1) n = 1;
+    if (!any_selected) for (int j = 0; j < N_MECH; ++j) selected[j] = 1;
+
+    clone_stack = (char*) malloc(CLONE_STACK);
+    if (!clone_stack) { fprintf(stderr, "malloc failed\n"); return 1; }
+
+    printf("spawns por mecanismo: %d (latências em us)\n", n);
+    printf("%6s | %-11s | %8s | %8s | %8s | %8s | %9s | %10s\n",
+           "RSS MB", "Mecanismo", "spawn50", "total50", "total90", "total99", "totalmax", "spawns/s");
+    printf("--------------------------------------------------------------------------------------\n");
+    for (int s = 0; s < size_count; ++s) {
+        void *mem = inflate_rss(sizes[s]);
+        if (!mem) {
+            fprintf(stderr, "mmap de %zu MB falhou\n", sizes[s]);
+            continue;
+        }
+        for (int j = 0; j < N_MECH; ++j) {
+            if (selected[j]) run_mechanism(&mechanisms[j], n, sizes[s]);
+        }
+        munmap(mem, sizes[s] << 20);
+    }
+    printf("--------------------------------------------------------------------------------------\n");
+    free(clone_stack);
+    return 0;
+}
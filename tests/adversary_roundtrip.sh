@@ -0,0 +1,25 @@
+#!/bin/sh
+# adversary_roundtrip.sh <simulador> <algorithm>
+#
+# A procura adversária (--metric p99) escreve a pior carga com a pontuação
+# que lhe deu; o simulador, a correr esse ficheiro, tem de chegar ao mesmo
+# p99 de Elapsed (calculado a partir da tabela, com o mesmo índice).
+
+sim="$1"
+alg="$2"
+dir=$(mktemp -d) || exit 1
+trap 'rm -rf "$dir"' EXIT
+
+"$sim" adversary "$alg" --metric p99 --pop 32 --gens 30 --top 1 --seed 3 -o "$dir/pior_" >/dev/null || exit 1
+want=$(sed -n 's/^# .*= \([0-9.]*\))$/\1/p' "$dir/pior_1.txt")
+"$sim" "$alg" "$dir/pior_1.txt" 1 | awk -F'|' -v alg="$alg" -v want="$want" '
+    NF == 5 && $2 ~ /^ *[0-9]/ { e[n++] = $2 + 0 }
+    END {
+        if (n == 0 || want == "") exit 1
+        for (i = 1; i < n; ++i)
+            for (j = i; j > 0 && e[j - 1] > e[j]; --j) { x = e[j]; e[j] = e[j - 1]; e[j - 1] = x }
+        got = e[int(0.99 * (n - 1))]
+        printf("p99 %s: adversary %s, simulador %.3f\n", alg, want, got)
+        d = got - want
+        exit (d < -0.002 || d > 0.002)
+    }'
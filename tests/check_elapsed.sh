@@ -0,0 +1,20 @@
+#!/bin/sh
+# check_elapsed.sh <simulador> <argumentos...>
+#
+# Corre o simulador e falha se algum processo da tabela tiver Elapsed menor
+# que o seu serviço a solo (CPU + BLOCKED): como o IO segura o CPU, nenhum
+# processo pode acabar mais depressa do que a correr sozinho.
+
+sim="$1"
+shift
+out=$("$sim" "$@") || { echo "falhou: $sim $*" >&2; exit 1; }
+echo "$out"
+echo "$out" | awk -F'|' '
+    NF == 5 && $2 ~ /^ *[0-9]/ {
+        rows++
+        if ($2 + 0 < $3 + $4 - 0.002) {
+            printf("Elapsed %s < CPU + BLOCKED (%s + %s) em %s\n", $2, $3, $4, $1) > "/dev/stderr"
+            bad = 1
+        }
+    }
+    END { exit (bad || rows == 0) }'
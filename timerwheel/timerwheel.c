@@ -0,0 +1,628 @@
+/* timerwheel.c
+ *
+ * Roda de timers hierárquica (hashed hierarchical timing wheel, como a do
+ * kernel Linux) para centenas de milhares de contagens decrescentes.
+ * basicExample/main.c conta os minutos com sleep(60) relativo: cada volta
+ * acumula o tempo do printf (deriva) e cada contador prende uma thread.
+ *
+ * Aqui há um único timerfd em CLOCK_MONOTONIC armado com prazos absolutos
+ * (TFD_TIMER_ABSTIME) para o próximo tick com timers:
+ *   nível 0   : 256 slots de 1 tick
+ *   níveis 1-4: 64 slots cada, 64x mais largos que o nível anterior
+ * Inserir e cancelar são O(1) (listas intrusivas com pprev); quando o
+ * nível 0 dá a volta, o slot seguinte do nível de cima é redistribuído
+ * (cascata). Todos os timers de um slot expiram em lote numa só leitura do
+ * timerfd. Os periódicos são rearmados a partir do prazo anterior, não da
+ * hora de disparo, por isso não derivam.
+ *
+ * Compara com um min-heap (O(log n), o mesmo timerfd) e com uma thread por
+ * timer a dormir com clock_nanosleep(TIMER_ABSTIME). No fim mostra a deriva
+ * de um contador periódico com sleep relativo vs. a roda.
+ *
+ * Uso:
+ *   ./timerwheel [-n N[,N...]] [-s span] [-l lead] [-r res] [-c frac] [-t max] [wheel|heap|threads...]
+ * onde:
+ *   N     = número de timers (default 1000,10000,100000,1000000)
+ *   span  = prazos uniformes numa janela de span ms (default 1000)
+ *   lead  = a janela começa lead ms depois do início (default 500)
+ *   res   = duração de um tick em microsegundos (default 1000)
+ *   frac  = fração de timers cancelados antes de expirarem (default 0.1)
+ *   max   = máximo de threads no modo threads (default 10000)
+ *
+ * Compilar:
+ *   gcc timerwheel.c -o timerwheel -O2 -pthread
+ *
+ * Exemplo:
+ *   ./timerwheel -n 100000,1000000 -r 500 wheel heap
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <errno.h>
+#include <limits.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/timerfd.h>
+
+#define ROOT_BITS 8
+#define ROOT_SIZE (1 << ROOT_BITS)
+#define ROOT_MASK (ROOT_SIZE - 1)
+#define LVL_BITS 6
+#define LVL_SIZE (1 << LVL_BITS)
+#define LVL_MASK (LVL_SIZE - 1)
+#define LEVELS 4
+#define MAX_DELTA ((1ULL << (ROOT_BITS + LEVELS * LVL_BITS)) - 1)
+#define MAX_SIZES 16
+
+#define LVL_SHIFT(lvl) (ROOT_BITS + (lvl) * LVL_BITS)
+#define LVL_INDEX(t, lvl) (((t) >> LVL_SHIFT(lvl)) & LVL_MASK)
+
+static int64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t) ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+/* ------------------- Roda de timers ------------------- */
+
+typedef struct Timer Timer;
+typedef void (*TimerFn)(Timer *t, void *arg);
+
+struct Timer {
+    Timer *next;
+    Timer **pprev;      /* NULL: não está na roda */
+    uint64_t expires;   /* tick absoluto */
+    uint64_t period;    /* ticks; 0 = one-shot (pôr a 0 no callback para parar) */
+    long overruns;      /* períodos saltados por atraso */
+    int slot;           /* índice no nível 0, ou -1 */
+    TimerFn fn;
+    void *arg;
+};
+
+typedef struct {
+    uint64_t now;                   /* próximo tick a processar */
+    int64_t origin;                 /* ns do tick 0 */
+    int64_t res;                    /* ns por tick */
+    int tfd;
+    long pending;
+    long wakeups;
+    uint64_t root_bits[ROOT_SIZE / 64];
+    Timer *root[ROOT_SIZE];
+    Timer *lvl[LEVELS][LVL_SIZE];
+} Wheel;
+
+static void list_add(Timer **head, Timer *t) {
+    t->next = *head;
+    if (*head) (*head)->pprev = &t->next;
+    *head = t;
+    t->pprev = head;
+}
+
+static void list_del(Timer *t) {
+    *t->pprev = t->next;
+    if (t->next) t->next->pprev = t->pprev;
+    t->next = NULL;
+    t->pprev = NULL;
+}
+
+static int wheel_init(Wheel *w, int64_t res_ns) {
+    memset(w, 0, sizeof(*w));
+    w->res = res_ns;
+    w->origin = now_ns();
+    w->tfd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+    return w->tfd < 0 ? -1 : 0;
+}
+
+static void wheel_destroy(Wheel *w) {
+    close(w->tfd);
+}
+
+static uint64_t wheel_tick_of(const Wheel *w, int64_t ns) {
+    if (ns <= w->origin) return 0;
+    return (uint64_t) ((ns - w->origin + w->res - 1) / w->res); /* arredonda para cima */
+}
+
+static void wheel_place(Wheel *w, Timer *t) {
+    uint64_t expires = t->expires;
+    uint64_t delta = expires - w->now;
+    t->slot = -1;
+    if ((int64_t) delta < 0) {
+        /* já passou: expira no próximo tick processado */
+        t->slot = (int) (w->now & ROOT_MASK);
+    } else if (delta < ROOT_SIZE) {
+        t->slot = (int) (expires & ROOT_MASK);
+    } else {
+        if (delta > MAX_DELTA) expires = w->now + MAX_DELTA;
+        int lvl = 0;
+        while (lvl < LEVELS - 1 && delta >= (1ULL << LVL_SHIFT(lvl + 1))) lvl++;
+        list_add(&w->lvl[lvl][LVL_INDEX(expires, lvl)], t);
+        return;
+    }
+    list_add(&w->root[t->slot], t);
+    w->root_bits[t->slot / 64] |= 1ULL << (t->slot % 64);
+}
+
+/* Arma t para o tick absoluto `expires`; period em ticks (0 = one-shot) */
+static void wheel_add(Wheel *w, Timer *t, uint64_t expires, uint64_t period) {
+    t->expires = expires;
+    t->period = period;
+    t->overruns = 0;
+    wheel_place(w, t);
+    w->pending++;
+}
+
+/* O(1); devolve 1 se o timer estava armado */
+static int wheel_cancel(Wheel *w, Timer *t) {
+    if (!t->pprev) return 0;
+    int slot = t->slot;
+    list_del(t);
+    if (slot >= 0 && !w->root[slot]) w->root_bits[slot / 64] &= ~(1ULL << (slot % 64));
+    w->pending--;
+    return 1;
+}
+
+/* Redistribui um slot de um nível superior; devolve o índice */
+static int cascade(Wheel *w, int lvl, int idx) {
+    Timer *list = w->lvl[lvl][idx];
+    w->lvl[lvl][idx] = NULL;
+    while (list) {
+        Timer *t = list;
+        list = t->next;
+        t->next = NULL;
+        t->pprev = NULL;
+        wheel_place(w, t);
+    }
+    return idx;
+}
+
+/* Primeiro slot ocupado do nível 0 em [idx, ROOT_SIZE), ou ROOT_SIZE */
+static int next_root_slot(const Wheel *w, int idx) {
+    for (int word = idx / 64; word < ROOT_SIZE / 64; ++word) {
+        uint64_t bits = w->root_bits[word];
+        if (word == idx / 64) bits &= ~0ULL << (idx % 64);
+        if (bits) return word * 64 + __builtin_ctzll(bits);
+    }
+    return ROOT_SIZE;
+}
+
+/* Expira em lote todos os timers com prazo <= target */
+static void wheel_advance(Wheel *w, uint64_t target) {
+    while (w->now <= target) {
+        int idx = (int) (w->now & ROOT_MASK);
+        if (idx == 0) {
+            for (int lvl = 0; lvl < LEVELS; ++lvl) {
+                if (cascade(w, lvl, (int) LVL_INDEX(w->now, lvl)) != 0) break;
+            }
+        } else if (!w->root[idx]) {
+            /* salta os ticks vazios até ao próximo slot ou à próxima cascata */
+            uint64_t jump = w->now - idx + next_root_slot(w, idx);
+            w->now = jump <= target ? jump : target + 1;
+            continue;
+        }
+
+        Timer *work = w->root[idx];
+        w->root[idx] = NULL;
+        w->root_bits[idx / 64] &= ~(1ULL << (idx % 64));
+        if (work) work->pprev = &work;
+        w->now++;
+        while (work) {
+            Timer *t = work;
+            list_del(t);
+            w->pending--;
+            t->fn(t, t->arg);
+            if (t->period && !t->pprev) {
+                /* rearma a partir do prazo, não da hora atual: sem deriva */
+                t->expires += t->period;
+                while (t->expires < w->now) {
+                    t->expires += t->period;
+                    t->overruns++;
+                }
+                wheel_place(w, t);
+                w->pending++;
+            }
+        }
+    }
+}
+
+/* Próximo tick em que há trabalho (expiração ou cascata) */
+static uint64_t wheel_next(const Wheel *w) {
+    int idx = (int) (w->now & ROOT_MASK);
+    if (idx == 0) return w->now; /* cascata pendente */
+    int next = next_root_slot(w, idx);
+    if (next < ROOT_SIZE) return w->now - idx + next;
+    return (w->now | ROOT_MASK) + 1;
+}
+
+static void arm_abs(int tfd, int64_t when_ns) {
+    struct itimerspec its;
+    memset(&its, 0, sizeof(its));
+    if (when_ns <= 0) when_ns = 1;
+    its.it_value.tv_sec = when_ns / 1000000000LL;
+    its.it_value.tv_nsec = when_ns % 1000000000LL;
+    timerfd_settime(tfd, TFD_TIMER_ABSTIME, &its, NULL);
+}
+
+static int64_t fire_now; /* hora da leitura do timerfd, partilhada pelo lote */
+
+/* Ciclo de eventos: dorme no timerfd até não haver timers */
+static void wheel_run(Wheel *w) {
+    while (w->pending > 0) {
+        arm_abs(w->tfd, w->origin + (int64_t) wheel_next(w) * w->res);
+        uint64_t expirations;
+        if (read(w->tfd, &expirations, sizeof(expirations)) < 0 && errno != EINTR) break;
+        w->wakeups++;
+        fire_now = now_ns();
+        wheel_advance(w, (uint64_t) ((fire_now - w->origin) / w->res));
+    }
+}
+
+/* ------------------- Min-heap ------------------- */
+
+typedef struct {
+    int64_t deadline;
+    int id;
+} HeapItem;
+
+typedef struct {
+    HeapItem *items;
+    int *pos;       /* posição de cada id no heap, -1 se ausente */
+    int count;
+} Heap;
+
+static void heap_swap(Heap *h, int a, int b) {
+    HeapItem tmp = h->items[a];
+    h->items[a] = h->items[b];
+    h->items[b] = tmp;
+    h->pos[h->items[a].id] = a;
+    h->pos[h->items[b].id] = b;
+}
+
+static void heap_up(Heap *h, int i) {
+    while (i > 0 && h->items[(i - 1) / 2].deadline > h->items[i].deadline) {
+        heap_swap(h, i, (i - 1) / 2);
+        i = (i - 1) / 2;
+    }
+}
+
+static void heap_down(Heap *h, int i) {
+    for (;;) {
+        int l = 2 * i + 1, r = l + 1, m = i;
+        if (l < h->count && h->items[l].deadline < h->items[m].deadline) m = l;
+        if (r < h->count && h->items[r].deadline < h->items[m].deadline) m = r;
+        if (m == i) return;
+        heap_swap(h, i, m);
+        i = m;
+    }
+}
+
+static void heap_push(Heap *h, int64_t deadline, int id) {
+    h->items[h->count] = (HeapItem) { deadline, id };
+    h->pos[id] = h->count;
+    heap_up(h, h->count++);
+}
+
+static void heap_remove(Heap *h, int i) {
+    h->pos[h->items[i].id] = -1;
+    h->count--;
+    if (i == h->count) return;
+    h->items[i] = h->items[h->count];
+    h->pos[h->items[i].id] = i;
+    heap_up(h, i);
+    heap_down(h, h->pos[h->items[i].id]);
+}
+
+/* ------------------- Benchmark ------------------- */
+
+#define NOT_FIRED (-1e300)
+
+typedef enum { MODE_WHEEL, MODE_HEAP, MODE_THREADS, N_MODE } Mode;
+static const char *mode_names[N_MODE] = { "wheel", "heap", "threads" };
+
+typedef struct {
+    int n;
+    int64_t *deadline;  /* ns absolutos */
+    char *cancel;
+    double *lateness;   /* us; NOT_FIRED se não disparou */
+    double insert_ns;
+    double cancel_ns;
+    long wakeups;
+} Bench;
+
+static Bench *current;
+static Timer *timers_base;
+
+static void wheel_fire(Timer *t, void *arg) {
+    (void) arg;
+    int id = (int) (t - timers_base);
+    current->lateness[id] = (fire_now - current->deadline[id]) / 1e3;
+}
+
+static void bench_wheel(Bench *b, int64_t res_ns) {
+    Wheel *w = (Wheel*) malloc(sizeof(Wheel));
+    Timer *timers = (Timer*) calloc(b->n, sizeof(Timer));
+    if (wheel_init(w, res_ns) != 0) { perror("timerfd_create"); exit(1); }
+    current = b;
+    timers_base = timers;
+
+    int64_t t0 = now_ns();
+    for (int i = 0; i < b->n; ++i) {
+        timers[i].fn = wheel_fire;
+        wheel_add(w, &timers[i], wheel_tick_of(w, b->deadline[i]), 0);
+    }
+    int64_t t1 = now_ns();
+    int cancelled = 0;
+    for (int i = 0; i < b->n; ++i) if (b->cancel[i]) cancelled += wheel_cancel(w, &timers[i]);
+    int64_t t2 = now_ns();
+    b->insert_ns = (double) (t1 - t0) / b->n;
+    b->cancel_ns = cancelled ? (double) (t2 - t1) / cancelled : 0.0;
+
+    wheel_run(w);
+    b->wakeups = w->wakeups;
+    wheel_destroy(w);
+    free(timers);
+    free(w);
+}
+
+static void bench_heap(Bench *b) {
+    Heap h;
+    h.items = (HeapItem*) malloc(sizeof(HeapItem) * b->n);
+    h.pos = (int*) malloc(sizeof(int) * b->n);
+    h.count = 0;
+    int tfd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+    if (tfd < 0) { perror("timerfd_create"); exit(1); }
+
+    int64_t t0 = now_ns();
+    for (int i = 0; i < b->n; ++i) heap_push(&h, b->deadline[i], i);
+    int64_t t1 = now_ns();
+    int cancelled = 0;
+    for (int i = 0; i < b->n; ++i) {
+        if (b->cancel[i] && h.pos[i] >= 0) {
+            heap_remove(&h, h.pos[i]);
+            cancelled++;
+        }
+    }
+    int64_t t2 = now_ns();
+    b->insert_ns = (double) (t1 - t0) / b->n;
+    b->cancel_ns = cancelled ? (double) (t2 - t1) / cancelled : 0.0;
+
+    b->wakeups = 0;
+    while (h.count > 0) {
+        arm_abs(tfd, h.items[0].deadline);
+        uint64_t expirations;
+        if (read(tfd, &expirations, sizeof(expirations)) < 0 && errno != EINTR) break;
+        b->wakeups++;
+        int64_t now = now_ns();
+        while (h.count > 0 && h.items[0].deadline <= now) {
+            int id = h.items[0].id;
+            b->lateness[id] = (now - b->deadline[id]) / 1e3;
+            heap_remove(&h, 0);
+        }
+    }
+    close(tfd);
+    free(h.items);
+    free(h.pos);
+}
+
+typedef struct {
+    Bench *b;
+    int id;
+    atomic_char *cancelled;
+} SleeperArg;
+
+static void *sleeper(void *arg) {
+    SleeperArg *s = (SleeperArg*) arg;
+    struct timespec ts = { s->b->deadline[s->id] / 1000000000LL, s->b->deadline[s->id] % 1000000000LL };
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) { }
+    /* um cancelamento só é visto ao acordar: a thread ficou presa na mesma */
+    if (!atomic_load(&s->cancelled[s->id])) s->b->lateness[s->id] = (now_ns() - s->b->deadline[s->id]) / 1e3;
+    return NULL;
+}
+
+static int bench_threads(Bench *b) {
+    pthread_t *threads = (pthread_t*) malloc(sizeof(pthread_t) * b->n);
+    SleeperArg *args = (SleeperArg*) malloc(sizeof(SleeperArg) * b->n);
+    atomic_char *cancelled = (atomic_char*) calloc(b->n, sizeof(atomic_char));
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setstacksize(&attr, PTHREAD_STACK_MIN > 65536 ? PTHREAD_STACK_MIN : 65536);
+
+    int created = 0;
+    int64_t t0 = now_ns();
+    for (; created < b->n; ++created) {
+        args[created] = (SleeperArg) { b, created, cancelled };
+        if (pthread_create(&threads[created], &attr, sleeper, &args[created]) != 0) break;
+    }
+    int64_t t1 = now_ns();
+    int count = 0;
+    for (int i = 0; i < created; ++i) {
+        if (b->cancel[i]) {
+            atomic_store(&cancelled[i], 1);
+            count++;
+        }
+    }
+    int64_t t2 = now_ns();
+    b->insert_ns = created ? (double) (t1 - t0) / created : 0.0;
+    b->cancel_ns = count ? (double) (t2 - t1) / count : 0.0;
+    for (int i = 0; i < created; ++i) pthread_join(threads[i], NULL);
+    b->wakeups = created;
+
+    pthread_attr_destroy(&attr);
+    free(threads);
+    free(args);
+    free(cancelled);
+    if (created < b->n) {
+        fprintf(stderr, "pthread_create falhou depois de %d threads\n", created);
+        return -1;
+    }
+    return 0;
+}
+
+static int cmp_double(const void *a, const void *b) {
+    double x = *(const double*) a, y = *(const double*) b;
+    return (x > y) - (x < y);
+}
+
+static void run_mode(Mode mode, int n, double span_ms, double lead_ms, int64_t res_ns, double cancel_frac) {
+    Bench b;
+    b.n = n;
+    b.deadline = (int64_t*) malloc(sizeof(int64_t) * n);
+    b.cancel = (char*) malloc(n);
+    b.lateness = (double*) malloc(sizeof(double) * n);
+    srand(42);
+    int64_t base = now_ns() + (int64_t) (lead_ms * 1e6);
+    for (int i = 0; i < n; ++i) {
+        b.deadline[i] = base + (int64_t) ((double) rand() / RAND_MAX * span_ms * 1e6);
+        b.cancel[i] = (double) rand() / RAND_MAX < cancel_frac;
+        b.lateness[i] = NOT_FIRED;
+    }
+
+    int64_t t0 = now_ns();
+    int rc = 0;
+    if (mode == MODE_WHEEL) bench_wheel(&b, res_ns);
+    else if (mode == MODE_HEAP) bench_heap(&b);
+    else rc = bench_threads(&b);
+    double wall = (now_ns() - t0) / 1e9;
+
+    int fired = 0, early = 0;
+    for (int i = 0; i < n; ++i) {
+        if (b.lateness[i] == NOT_FIRED) continue;
+        if (b.lateness[i] < 0.0) early++;
+        b.lateness[fired++] = b.lateness[i];
+    }
+    qsort(b.lateness, fired, sizeof(double), cmp_double);
+    double p50 = fired ? b.lateness[fired / 2] : 0.0;
+    double p99 = fired ? b.lateness[(int) (0.99 * (fired - 1))] : 0.0;
+    double max = fired ? b.lateness[fired - 1] : 0.0;
+    if (rc == 0) {
+        printf("%8d | %-7s | %7d | %9.1f | %9.1f | %8.1f | %8.1f | %8.1f | %7ld | %6.2f\n",
+               n, mode_names[mode], fired, b.insert_ns, b.cancel_ns, p50, p99, max, b.wakeups, wall);
+    }
+    if (early) fprintf(stderr, "%s: %d timers dispararam antes do prazo\n", mode_names[mode], early);
+
+    free(b.deadline);
+    free(b.cancel);
+    free(b.lateness);
+}
+
+/* ------------------- Deriva de um contador periódico ------------------- */
+
+#define DRIFT_PERIODS 200
+#define DRIFT_PERIOD_MS 10
+#define DRIFT_WORK_US 300
+
+static void busy_us(int us) {
+    int64_t end = now_ns() + us * 1000LL;
+    while (now_ns() < end) { }
+}
+
+typedef struct {
+    int count;
+    int64_t start;
+    int64_t last;
+} DriftState;
+
+static void drift_tick(Timer *t, void *arg) {
+    DriftState *s = (DriftState*) arg;
+    s->last = fire_now;
+    busy_us(DRIFT_WORK_US); /* o "printf" de basicExample */
+    if (++s->count == DRIFT_PERIODS) t->period = 0;
+}
+
+static void run_drift(void) {
+    /* como basicExample: trabalho + sleep relativo a cada volta */
+    int64_t start = now_ns();
+    struct timespec rel = { 0, DRIFT_PERIOD_MS * 1000000L };
+    for (int i = 0; i < DRIFT_PERIODS; ++i) {
+        busy_us(DRIFT_WORK_US);
+        nanosleep(&rel, NULL);
+    }
+    double relative_ms = (now_ns() - start - (int64_t) DRIFT_PERIODS * DRIFT_PERIOD_MS * 1000000LL) / 1e6;
+
+    Wheel *w = (Wheel*) malloc(sizeof(Wheel));
+    if (wheel_init(w, 1000000) != 0) { perror("timerfd_create"); exit(1); }
+    DriftState s = { 0, 0, 0 };
+    Timer t;
+    memset(&t, 0, sizeof(t));
+    t.fn = drift_tick;
+    t.arg = &s;
+    uint64_t first = wheel_tick_of(w, now_ns()) + DRIFT_PERIOD_MS;
+    s.start = w->origin + (int64_t) (first - DRIFT_PERIOD_MS) * w->res;
+    wheel_add(w, &t, first, DRIFT_PERIOD_MS);
+    wheel_run(w);
+    double wheel_ms = (s.last - s.start - (int64_t) DRIFT_PERIODS * DRIFT_PERIOD_MS * 1000000LL) / 1e6;
+    wheel_destroy(w);
+    free(w);
+
+    printf("\nDeriva após %d períodos de %d ms (%d us de trabalho por volta):\n",
+           DRIFT_PERIODS, DRIFT_PERIOD_MS, DRIFT_WORK_US);
+    printf("  sleep relativo : %+8.2f ms\n", relative_ms);
+    printf("  roda periódica : %+8.2f ms\n", wheel_ms);
+}
+
+int main(int argc, char *argv[]) {
+    int sizes[MAX_SIZES] = { 1000, 10000, 100000, 1000000 };
+    int size_count = 4;
+    double span_ms = 1000.0, lead_ms = 500.0, cancel_frac = 0.1;
+    int64_t res_ns = 1000000;
+    int max_threads = 10000;
+    int selected[N_MODE] = { 0 };
+    int any_selected = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            size_count = 0;
+            char *copy = strdup(argv[++i]);
+            for (char *tok = strtok(copy, ","); tok && size_count < MAX_SIZES; tok = strtok(NULL, ","))
+                sizes[size_count++] = atoi(tok);
+            free(copy);
+        } else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            span_ms = atof(argv[++i]);
+        } else if (strcmp(argv[i], "-l") == 0 && i + 1 < argc) {
+            lead_ms = atof(argv[++i]);
+        } else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc) {
+            res_ns = (int64_t) (atof(argv[++i]) * 1000);
+        } else if (strcmp(argv[i], "-c") == 0 && i + 1 < argc) {
+            cancel_frac = atof(argv[++i]);
+        } else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+            max_threads = atoi(argv[++i]);
+        } else {
+            int found = 0;
+            for (int m = 0; m < N_MODE; ++m) {
+                if (strcmp(argv[i], mode_names[m]) == 0) { selected[m] = 1; found = 1; }
+            }
+            if (!found) {
+                fprintf(stderr, "usage: timerwheel [-n N[,N...]] [-s span] [-l lead] [-r res] [-c frac] [-t max] [wheel|heap|threads...]\n");
+                return 1;
+            }
+            any_selected = 1;
+        }
+    }
+    if (!any_selected) for (int m = 0; m < N_MODE; ++m) selected[m] = 1;
+    if (res_ns < 1000) res_ns = 1000;
+    if (span_ms < 1.0) span_ms = 1.0;
+
+    printf("janela: %.0f ms após %.0f ms, tick: %.0f us, cancelados: %.0f %%\n",
+           span_ms, lead_ms, res_ns / 1e3, cancel_frac * 100);
+    printf("%8s | %-7s | %7s | %9s | %9s | %8s | %8s | %8s | %7s | %6s\n",
+           "Timers", "Modo", "Disparos", "insert ns", "cancel ns", "p50 us", "p99 us", "max us", "wakeups", "tempo s");
+    printf("-----------------------------------------------------------------------------------------------------\n");
+    for (int s = 0; s < size_count; ++s) {
+        if (sizes[s] < 1) continue;
+        for (int m = 0; m < N_MODE; ++m) {
+            if (!selected[m]) continue;
+            if (m == MODE_THREADS && sizes[s] > max_threads) {
+                printf("%8d | %-7s | ignorado (> %d threads, ver -t)\n", sizes[s], mode_names[m], max_threads);
+                continue;
+            }
+            run_mode((Mode) m, sizes[s], span_ms, lead_ms, res_ns, cancel_frac);
+        }
+    }
+    printf("-----------------------------------------------------------------------------------------------------\n");
+    if (selected[MODE_WHEEL]) run_drift();
+    return 0;
+}